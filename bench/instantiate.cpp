@@ -0,0 +1,5 @@
+#include "message.hpp"
+
+#ifdef PYXI_BENCH_EXTERN
+PYXI_INSTANTIATE_POLICY(Message)
+#endif
@@ -23,12 +23,19 @@
 #ifndef PYXI_HPP
 #define PYXI_HPP
 
+#include <algorithm>
 #include <array>
+#include <atomic>
 #include <climits>
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <ratio>
 #include <stdexcept>
+#include <tuple>
 #include <type_traits>
 #include <utility>
 #include <vector>
@@ -43,6 +50,19 @@
 #error "Unsupported C++ version (<11)"
 #endif
 
+#if PYXI_CXX >= 17
+#include <optional>
+#include <variant>
+#endif
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#if defined(__F16C__)
+#include <immintrin.h>
+#endif
+
 namespace pyxi
 {
 
@@ -98,6 +118,54 @@ struct is_resizable<
     : public std::true_type
 {};
 
+///////////////////////
+//// is_reservable ////
+///////////////////////
+
+template <typename, typename = void>
+struct is_reservable : public std::false_type
+{};
+
+template <typename T>
+struct is_reservable<
+    T,
+    void_t<decltype(std::declval<T&>().reserve(
+        std::declval<decltype(std::declval<const T&>().size())>()))>>
+    : public std::true_type
+{};
+
+////////////////////////
+//// is_associative ////
+////////////////////////
+
+template <typename, typename = void>
+struct is_associative : public std::false_type
+{};
+
+template <typename T>
+struct is_associative<
+    T,
+    void_t<typename T::key_type,
+           decltype(std::declval<T&>().emplace_hint(
+               std::declval<T&>().end(),
+               std::declval<typename T::value_type>()))>>
+    : public std::true_type
+{};
+
+////////////////////
+//// is_mapping ////
+////////////////////
+
+template <typename, typename = void>
+struct is_mapping : public std::false_type
+{};
+
+template <typename T>
+struct is_mapping<T,
+                  void_t<typename T::key_type, typename T::mapped_type>>
+    : public std::true_type
+{};
+
 /////////////////////
 //// is_iterable ////
 /////////////////////
@@ -113,6 +181,39 @@ struct is_iterable<
     : public std::true_type
 {};
 
+////////////////////////////////
+//// is_equality_comparable ////
+////////////////////////////////
+
+template <typename, typename = void>
+struct is_equality_comparable : public std::false_type
+{};
+
+template <typename T>
+struct is_equality_comparable<
+    T,
+    enable_if_t<std::is_convertible<decltype(std::declval<const T&>() ==
+                                             std::declval<const T&>()),
+                                    bool>::value>>
+    : public std::true_type
+{};
+
+///////////////////////
+//// is_contiguous ////
+///////////////////////
+
+template <typename, typename = void>
+struct is_contiguous : public std::false_type
+{};
+
+template <typename T>
+struct is_contiguous<
+    T,
+    enable_if_t<std::is_same<decltype(std::declval<const T&>().data()),
+                             const typename T::value_type*>::value>>
+    : public std::true_type
+{};
+
 ////////////////
 //// Policy ////
 ////////////////
@@ -138,13 +239,37 @@ struct Policy
 template <typename T>
 struct Policy<T, void, Priority::Last>
 {
-	static_assert(false, "No policy exists for this type");
+	static_assert(sizeof(T) == 0, "No policy exists for this type");
+};
+
+namespace detail
+{
+	// Whether T is encoded by its policy at level P rather than by a more
+	// specific one in front of it.
+	template <typename T, Priority P>
+	struct uses_policy : public std::is_base_of<Policy<T, void, P>, Policy<T>>
+	{};
+} // namespace detail
+
+////////////////////
+//// Byte Order ////
+////////////////////
+
+enum class ByteOrder
+{
+	MsbFirst,
+	LsbFirst
 };
 
 ////////////////////
 //// Serializer ////
 ////////////////////
 
+namespace detail
+{
+	class RecordingSerializer;
+}
+
 class Serializer
 {
 public:
@@ -157,8 +282,53 @@ public:
 	template <typename T, typename = enable_if_t<std::is_integral<T>::value>>
 	void give(T data, size_t bits = bitsize<T>::value);
 
+	template <typename T, typename = enable_if_t<std::is_integral<T>::value>>
+	void give_many(const T* data,
+	               size_t count,
+	               size_t bits = bitsize<T>::value);
+
+	void write_bytes(const void* data, size_t count);
+
+	bool write_encoded(const void* data, size_t bits, ByteOrder byteOrder);
+
+	// Pads with zero bits up to the next multiple of width bits.
+	void align(size_t width);
+
+	size_t tell() const noexcept { return position_; }
+
+	// What has been given so far only encodes the same way again when it
+	// starts at a position congruent to this many bits, as it was aligned.
+	size_t alignment() const noexcept { return alignment_; }
+
 protected:
+	Serializer() = default;
+
+	// Starts counting from where the output will be placed in another stream.
+	explicit Serializer(size_t position) noexcept
+	    : position_(position)
+	{}
+
 	virtual void impl(size_t data, size_t bits) = 0;
+
+	// Gives count values of size bytes each, laid out as in memory.
+	virtual void implMany(const void* data,
+	                      size_t size,
+	                      size_t count,
+	                      size_t bits);
+
+	virtual void implBytes(const uint8_t* bytes, size_t count);
+
+	// Appends bits another serializer produced in the given byte order, or
+	// returns false if they can not be taken as they are.
+	virtual bool implEncoded(const uint8_t* bytes,
+	                         size_t bits,
+	                         ByteOrder byteOrder);
+
+private:
+	friend class detail::RecordingSerializer;
+
+	size_t position_  = 0;
+	size_t alignment_ = 1;
 };
 
 template <typename T>
@@ -197,7 +367,170 @@ void Serializer::give(const T data, size_t bits)
 	else
 	{
 		impl(data, bits);
+		position_ += bits;
+	}
+}
+
+template <typename T, typename>
+void Serializer::give_many(const T* data, size_t count, size_t bits)
+{
+	if (bits > bitsize<T>::value)
+	{
+		throw std::invalid_argument(
+		    "Attempting to invoke serializer with bit size exceeding given "
+		    "type");
+	}
+	if (sizeof(T) > sizeof(size_t))
+	{
+		throw std::invalid_argument(
+		    "Attempting to invoke serializer with bit size exceeding platform "
+		    "support");
+	}
+	else if (bits == 0)
+	{
+		throw std::invalid_argument(
+		    "Attempting to invoke serializer with no bits");
+	}
+	else if (count != 0)
+	{
+		implMany(data, sizeof(T), count, bits);
+		position_ += bits * count;
+	}
+}
+
+namespace detail
+{
+	inline size_t lcm(size_t a, size_t b) noexcept
+	{
+		size_t x = a;
+		for (size_t y = b; y != 0;)
+		{
+			const size_t r = x % y;
+			x              = y;
+			y              = r;
+		}
+
+		return a / x * b;
+	}
+
+	template <typename U>
+	size_t load_as(const void* p) noexcept
+	{
+		U v;
+		std::memcpy(&v, p, sizeof(U));
+		return static_cast<size_t>(v);
+	}
+
+	template <typename U>
+	void store_as(void* p, size_t v) noexcept
+	{
+		const U n = static_cast<U>(v);
+		std::memcpy(p, &n, sizeof(U));
+	}
+
+	inline size_t load_value(const void* p, size_t size) noexcept
+	{
+		if (size == 1)
+		{
+			return load_as<uint8_t>(p);
+		}
+		else if (size == 2)
+		{
+			return load_as<uint16_t>(p);
+		}
+		else if (size == 4)
+		{
+			return load_as<uint32_t>(p);
+		}
+		else
+		{
+			return load_as<uint64_t>(p);
+		}
+	}
+
+	inline void store_value(void* p, size_t size, size_t v) noexcept
+	{
+		if (size == 1)
+		{
+			store_as<uint8_t>(p, v);
+		}
+		else if (size == 2)
+		{
+			store_as<uint16_t>(p, v);
+		}
+		else if (size == 4)
+		{
+			store_as<uint32_t>(p, v);
+		}
+		else
+		{
+			store_as<uint64_t>(p, v);
+		}
+	}
+} // namespace detail
+
+inline void Serializer::implMany(const void* data,
+                                 size_t size,
+                                 size_t count,
+                                 size_t bits)
+{
+	const uint8_t* p = static_cast<const uint8_t*>(data);
+
+	for (size_t i = 0; i < count; ++i, p += size)
+	{
+		impl(detail::load_value(p, size), bits);
+	}
+}
+
+inline void Serializer::write_bytes(const void* data, size_t count)
+{
+	if (count != 0)
+	{
+		implBytes(static_cast<const uint8_t*>(data), count);
+		position_ += count * bitsize<>::value;
+	}
+}
+
+inline void Serializer::implBytes(const uint8_t* bytes, size_t count)
+{
+	while (count--)
+	{
+		impl(*(bytes++), bitsize<>::value);
+	}
+}
+
+inline void Serializer::align(size_t width)
+{
+	for (size_t pad = (width - position_ % width) % width; pad != 0;)
+	{
+		const size_t n =
+		    pad < bitsize<size_t>::value ? pad : bitsize<size_t>::value;
+
+		impl(0, n);
+		position_ += n;
+		pad       -= n;
+	}
+
+	alignment_ = detail::lcm(alignment_, width);
+}
+
+inline bool Serializer::write_encoded(const void* data,
+                                      size_t bits,
+                                      ByteOrder byteOrder)
+{
+	if (bits != 0 &&
+	    !implEncoded(static_cast<const uint8_t*>(data), bits, byteOrder))
+	{
+		return false;
 	}
+
+	position_ += bits;
+	return true;
+}
+
+inline bool Serializer::implEncoded(const uint8_t*, size_t, ByteOrder)
+{
+	return false;
 }
 
 //////////////////////
@@ -216,8 +549,34 @@ public:
 	template <typename T, typename = enable_if_t<std::is_integral<T>::value>>
 	T take(size_t bits = bitsize<T>::value);
 
+	template <typename T, typename = enable_if_t<std::is_integral<T>::value>>
+	void take_many(T* data, size_t count, size_t bits = bitsize<T>::value);
+
+	void read_bytes(void* data, size_t count);
+
+	void skip(size_t bits);
+
+	// Skips up to the next multiple of width bits.
+	void align(size_t width) { skip((width - position_ % width) % width); }
+
+	size_t tell() const noexcept { return position_; }
+
 protected:
 	virtual void impl(size_t& data, size_t bits, bool signExtend) = 0;
+
+	// Takes count values of size bytes each, laid out as in memory.
+	virtual void implMany(void* data,
+	                      size_t size,
+	                      size_t count,
+	                      size_t bits,
+	                      bool signExtend);
+
+	virtual void implBytes(uint8_t* bytes, size_t count);
+
+	virtual void implSkip(size_t bits);
+
+private:
+	size_t position_ = 0;
 };
 
 template <typename T>
@@ -258,10 +617,93 @@ inline T Deserializer::take(size_t bits)
 	{
 		size_t v{};
 		impl(v, bits, std::is_signed<T>::value);
+		position_ += bits;
 		return static_cast<T>(v);
 	}
 }
 
+template <typename T, typename>
+inline void Deserializer::take_many(T* data, size_t count, size_t bits)
+{
+	if (bits > bitsize<T>::value)
+	{
+		throw std::invalid_argument(
+		    "Attempting to invoke deserializer with bit size exceeding given "
+		    "type");
+	}
+	if (sizeof(T) > sizeof(size_t))
+	{
+		throw std::invalid_argument(
+		    "Attempting to invoke deserializer with bit size exceeding "
+		    "platform "
+		    "support");
+	}
+	else if (bits == 0)
+	{
+		throw std::invalid_argument(
+		    "Attempting to invoke deserializer with no bits");
+	}
+	else if (count != 0)
+	{
+		implMany(data, sizeof(T), count, bits, std::is_signed<T>::value);
+		position_ += bits * count;
+	}
+}
+
+inline void Deserializer::implMany(void* data,
+                                   size_t size,
+                                   size_t count,
+                                   size_t bits,
+                                   bool signExtend)
+{
+	uint8_t* p = static_cast<uint8_t*>(data);
+
+	for (size_t i = 0; i < count; ++i, p += size)
+	{
+		size_t v{};
+		impl(v, bits, signExtend);
+		detail::store_value(p, size, v);
+	}
+}
+
+inline void Deserializer::read_bytes(void* data, size_t count)
+{
+	if (count != 0)
+	{
+		implBytes(static_cast<uint8_t*>(data), count);
+		position_ += count * bitsize<>::value;
+	}
+}
+
+inline void Deserializer::implBytes(uint8_t* bytes, size_t count)
+{
+	while (count--)
+	{
+		size_t v{};
+		impl(v, bitsize<>::value, false);
+		*(bytes++) = static_cast<uint8_t>(v);
+	}
+}
+
+inline void Deserializer::skip(size_t bits)
+{
+	implSkip(bits);
+	position_ += bits;
+}
+
+inline void Deserializer::implSkip(size_t bits)
+{
+	size_t v;
+
+	while (bits != 0)
+	{
+		const size_t n = bits < bitsize<size_t>::value ? bits
+		                                               : bitsize<size_t>::value;
+		impl(v, n, false);
+		bits -= n;
+	}
+}
+
 ////////////////////////
 //// has_serializer ////
 ////////////////////////
@@ -317,7 +759,8 @@ struct Policy<
 
 	static void deserialize(T& t, Deserializer& des)
 	{
-		static_assert(false, "Type has not implemented a deserializer");
+		static_assert(sizeof(T) == 0,
+		              "Type has not implemented a deserializer");
 	}
 };
 
@@ -329,7 +772,8 @@ struct Policy<
 {
 	static void serialize(const T& t, Serializer& ser)
 	{
-		static_assert(false, "Type has not implemented a serializer");
+		static_assert(sizeof(T) == 0,
+		              "Type has not implemented a serializer");
 	}
 
 	static void deserialize(T& t, Deserializer& des) { t.deserialize(des); }
@@ -425,25 +869,104 @@ struct Policy<T,
 //// Collection Policy ////
 ///////////////////////////
 
-template <typename T>
-struct Policy<T,
-              enable_if_t<is_resizable<T>::value && is_iterable<T>::value>,
-              Priority::Primary>
+namespace detail
 {
-	static void serialize(const T& t, Serializer& ser)
+	// Elements that contiguous collections hand over a run at a time. A run
+	// is copied as raw memory, which bool can not take.
+	template <typename T, typename = void>
+	struct bulk_elements : public std::false_type
+	{};
+
+	template <typename T>
+	struct bulk_elements<T,
+	                     enable_if_t<std::is_integral<T>::value &&
+	                                 !std::is_same<T, bool>::value>>
+	    : public std::true_type
 	{
-		ser.put(t.size());
+		static void put(const T* p, size_t count, Serializer& ser)
+		{
+			ser.give_many(p, count);
+		}
+
+		static void get(T* p, size_t count, Deserializer& des)
+		{
+			des.take_many(p, count);
+		}
+	};
+
+	template <typename T>
+	struct bulk_elements<T,
+	                     void_t<typename floating_width_equivalent<T>::type>>
+	    : public std::true_type
+	{
+		using E = typename floating_width_equivalent<T>::type;
+
+		static void put(const T* p, size_t count, Serializer& ser)
+		{
+			ser.give_many(reinterpret_cast<const E*>(p), count);
+		}
 
+		static void get(T* p, size_t count, Deserializer& des)
+		{
+			des.take_many(reinterpret_cast<E*>(p), count);
+		}
+	};
+
+	template <typename T, typename = void>
+	struct is_bulk : public std::false_type
+	{};
+
+	template <typename T>
+	struct is_bulk<T,
+	               enable_if_t<is_contiguous<T>::value &&
+	                           bulk_elements<typename T::value_type>::value>>
+	    : public std::true_type
+	{};
+
+	template <typename T>
+	void put_elements(const T& t, Serializer& ser, std::false_type)
+	{
 		for (auto it = t.begin(); it != t.end(); ++it)
 		{
 			ser.put(*it);
 		}
 	}
 
+	template <typename T>
+	void put_elements(const T& t, Serializer& ser, std::true_type)
+	{
+		bulk_elements<typename T::value_type>::put(t.data(), t.size(), ser);
+	}
+} // namespace detail
+
+template <typename T>
+struct Policy<T,
+              enable_if_t<is_resizable<T>::value && is_iterable<T>::value>,
+              Priority::Primary>
+{
+	static void serialize(const T& t, Serializer& ser)
+	{
+		ser.put(t.size());
+
+		detail::put_elements(t, ser, detail::is_bulk<T>{});
+	}
+
 	static void deserialize(T& t, Deserializer& des)
 	{
 		decltype(t.size()) size;
 		des.get(size);
+
+		deserialize(t, size, des, detail::is_bulk<T>{});
+	}
+
+private:
+	static void deserialize(T& t,
+	                        decltype(t.size()) size,
+	                        Deserializer& des,
+	                        std::false_type)
+	{
+		// Elements already present are decoded in place so that their own
+		// storage (string buffers, nested collections) is reused.
 		t.resize(size);
 
 		for (auto it = t.begin(); it != t.end(); ++it)
@@ -451,28 +974,155 @@ struct Policy<T,
 			des.get(*it);
 		}
 	}
+
+	// Elements already present are decoded over in place. Growing appends
+	// from a small buffer instead, since resizing would first fill the new
+	// elements only for them to be overwritten.
+	static void deserialize(T& t,
+	                        decltype(t.size()) size,
+	                        Deserializer& des,
+	                        std::true_type)
+	{
+		using V = typename T::value_type;
+
+		const auto reused = size < t.size() ? size : t.size();
+		t.resize(reused);
+
+		if (reused != 0)
+		{
+			detail::bulk_elements<V>::get(&t[0], reused, des);
+		}
+
+		reserve(t, size, is_reservable<T>{});
+
+		V buffer[256];
+		for (auto left = size - reused; left != 0;)
+		{
+			const size_t n = left < 256 ? left : 256;
+
+			detail::bulk_elements<V>::get(buffer, n, des);
+			t.insert(t.end(), buffer, buffer + n);
+
+			left -= n;
+		}
+	}
+
+	static void reserve(T&, decltype(std::declval<T&>().size()), std::false_type)
+	{}
+
+	static void reserve(T& t, decltype(t.size()) size, std::true_type)
+	{
+		t.reserve(size);
+	}
 };
 
 template <typename T>
 struct Policy<T,
-              enable_if_t<!is_resizable<T>::value && is_iterable<T>::value>,
+              enable_if_t<!is_resizable<T>::value && !is_associative<T>::value &&
+                          is_iterable<T>::value>,
               Priority::Primary>
 {
 	static void serialize(const T& t, Serializer& ser)
+	{
+		detail::put_elements(t, ser, detail::is_bulk<T>{});
+	}
+
+	static void deserialize(T& t, Deserializer& des)
+	{
+		deserialize(t, des, detail::is_bulk<T>{});
+	}
+
+private:
+	static void deserialize(T& t, Deserializer& des, std::false_type)
 	{
 		for (auto it = t.begin(); it != t.end(); ++it)
 		{
-			ser.put(*it);
+			des.get(*it);
 		}
 	}
 
-	static void deserialize(T& t, Deserializer& des)
+	static void deserialize(T& t, Deserializer& des, std::true_type)
+	{
+		detail::bulk_elements<typename T::value_type>::get(
+		    t.data(), t.size(), des);
+	}
+};
+
+////////////////////////////
+//// Associative Policy ////
+////////////////////////////
+
+template <typename T>
+struct Policy<T, enable_if_t<is_associative<T>::value>, Priority::Primary>
+{
+	static void serialize(const T& t, Serializer& ser)
 	{
+		ser.put(t.size());
+
 		for (auto it = t.begin(); it != t.end(); ++it)
 		{
-			des.get(*it);
+			put(*it, ser, is_mapping<T>{});
+		}
+	}
+
+	static void deserialize(T& t, Deserializer& des)
+	{
+		decltype(t.size()) size;
+		des.get(size);
+
+		t.clear();
+		reserve(t, size, is_reservable<T>{});
+
+		// Ordered containers were written in order, so inserting at the end
+		// is amortized constant rather than a full lookup per element.
+		for (decltype(size) i = 0; i < size; ++i)
+		{
+			emplace(t, des, is_mapping<T>{});
 		}
 	}
+
+private:
+	static void put(const typename T::value_type& v,
+	                Serializer& ser,
+	                std::false_type)
+	{
+		ser.put(v);
+	}
+
+	static void put(const typename T::value_type& v,
+	                Serializer& ser,
+	                std::true_type)
+	{
+		ser.put(v.first);
+		ser.put(v.second);
+	}
+
+	static void reserve(T&, decltype(std::declval<T&>().size()), std::false_type)
+	{}
+
+	static void reserve(T& t, decltype(t.size()) size, std::true_type)
+	{
+		t.reserve(size);
+	}
+
+	static void emplace(T& t, Deserializer& des, std::false_type)
+	{
+		typename T::key_type k{};
+		des.get(k);
+
+		t.emplace_hint(t.end(), std::move(k));
+	}
+
+	static void emplace(T& t, Deserializer& des, std::true_type)
+	{
+		typename T::key_type k{};
+		des.get(k);
+
+		typename T::mapped_type v{};
+		des.get(v);
+
+		t.emplace_hint(t.end(), std::move(k), std::move(v));
+	}
 };
 
 //////////////////
@@ -488,14 +1138,33 @@ struct sequence
 
 namespace detail
 {
-	template <size_t C, size_t... Is>
-	struct make_sequence_impl : public make_sequence_impl<C - 1, C - 1, Is...>
+	template <typename, typename>
+	struct concat_sequence;
+
+	template <size_t... Is, size_t... Js>
+	struct concat_sequence<sequence<Is...>, sequence<Js...>>
+	{
+		using type = sequence<Is..., (sizeof...(Is) + Js)...>;
+	};
+
+	// Halving keeps the instantiation depth logarithmic and lets both halves
+	// share instantiations.
+	template <size_t C>
+	struct make_sequence_impl
+	    : public concat_sequence<typename make_sequence_impl<C / 2>::type,
+	                             typename make_sequence_impl<C - C / 2>::type>
 	{};
 
-	template <size_t... Is>
-	struct make_sequence_impl<0, Is...>
+	template <>
+	struct make_sequence_impl<0>
 	{
-		using type = sequence<Is...>;
+		using type = sequence<>;
+	};
+
+	template <>
+	struct make_sequence_impl<1>
+	{
+		using type = sequence<0>;
 	};
 } // namespace detail
 
@@ -538,56 +1207,81 @@ using is_initializable = detail::is_initializable_impl<T, void, Ts...>;
 
 namespace detail
 {
-	template <typename, typename, typename = void, typename...>
-	struct member_pack_impl
+	template <typename T, size_t>
+	struct repeat
 	{
-		using type = pack<>;
+		using type = T;
 	};
 
-	template <typename T, typename Atom>
-	struct member_pack_impl<T,
-	                        Atom,
-	                        enable_if_t<!std::is_empty<T>::value &&
-	                                    std::is_standard_layout<T>::value &&
-	                                    std::is_class<T>::value>>
-	    : public member_pack_impl<T, Atom, void, Atom>
+	template <typename, typename, typename>
+	struct is_initializable_repeat;
+
+	template <typename T, typename Atom, size_t... Is>
+	struct is_initializable_repeat<T, Atom, sequence<Is...>>
+	    : public is_initializable<T, typename repeat<Atom, Is>::type...>
 	{};
 
-	template <typename T, typename Atom, typename T0, typename... Ts>
-	struct member_pack_impl<
-	    T,
-	    Atom,
-	    enable_if_t<is_initializable<T, T0, Ts..., T0, Ts...>::value>,
-	    T0,
-	    Ts...> : public member_pack_impl<T, Atom, void, T0, Ts..., T0, Ts...>
+	template <typename T, typename Atom, size_t N>
+	using is_initializable_with =
+	    is_initializable_repeat<T, Atom, make_sequence<N>>;
+
+	// T is known to be initializable with Lo atoms and not with Hi atoms.
+	template <typename T,
+	          typename Atom,
+	          size_t Lo,
+	          size_t Hi,
+	          bool = (Hi - Lo > 1)>
+	struct member_pack_search
+	    : public std::conditional<
+	          is_initializable_with<T, Atom, (Lo + Hi) / 2>::value,
+	          member_pack_search<T, Atom, (Lo + Hi) / 2, Hi>,
+	          member_pack_search<T, Atom, Lo, (Lo + Hi) / 2>>::type
 	{};
 
-	template <typename T, typename Atom, typename T0, typename... Ts>
-	struct member_pack_impl<
-	    T,
-	    Atom,
-	    enable_if_t<is_initializable<T, T0, Ts...>::value &&
-	                is_initializable<T, Atom, T0, Ts...>::value &&
-	                !is_initializable<T, T0, Ts..., T0, Ts...>::value>,
-	    T0,
-	    Ts...> : public member_pack_impl<T, Atom, void, Atom, T0, Ts...>
+	template <typename T, typename Atom, size_t Lo, size_t Hi>
+	struct member_pack_search<T, Atom, Lo, Hi, false>
+	    : public std::integral_constant<size_t, Lo>
 	{};
 
-	template <typename T, typename Atom, typename T0, typename... Ts>
-	struct member_pack_impl<
-	    T,
-	    Atom,
-	    enable_if_t<is_initializable<T, T0, Ts...>::value &&
-	                !is_initializable<T, Atom, T0, Ts...>::value>,
-	    T0,
-	    Ts...>
+	template <typename T,
+	          typename Atom,
+	          size_t N,
+	          bool = is_initializable_with<T, Atom, N>::value>
+	struct member_pack_bound : public member_pack_bound<T, Atom, N * 2>
+	{};
+
+	template <typename T, typename Atom, size_t N>
+	struct member_pack_bound<T, Atom, N, false>
+	    : public member_pack_search<T, Atom, N / 2, N>
+	{};
+
+	template <typename T, typename Atom, typename = void>
+	struct member_pack_count : public std::integral_constant<size_t, 0>
+	{};
+
+	template <typename T, typename Atom>
+	struct member_pack_count<T,
+	                         Atom,
+	                         enable_if_t<!std::is_empty<T>::value &&
+	                                     std::is_standard_layout<T>::value &&
+	                                     std::is_class<T>::value>>
+	    : public member_pack_bound<T, Atom, 1>
+	{};
+
+	template <typename, typename>
+	struct repeat_pack;
+
+	template <typename Atom, size_t... Is>
+	struct repeat_pack<Atom, sequence<Is...>>
 	{
-		using type = pack<T0, Ts...>;
+		using type = pack<typename repeat<Atom, Is>::type...>;
 	};
 } // namespace detail
 
 template <typename T, typename Atom>
-using member_pack = typename detail::member_pack_impl<T, Atom>::type;
+using member_pack = typename detail::repeat_pack<
+    Atom,
+    make_sequence<detail::member_pack_count<T, Atom>::value>>::type;
 
 //////////////////////
 //// member_count ////
@@ -598,23 +1292,167 @@ namespace detail
 	struct atom
 	{
 		template <typename T>
-		constexpr operator T();
+		constexpr operator T() const;
 	};
-
-	template <typename... Ts>
-	constexpr size_t member_count_impl(pack<Ts...>) noexcept
-	{
-		return sizeof...(Ts);
-	}
 } // namespace detail
 
 template <typename T>
 struct member_count
-    : public std::integral_constant<size_t,
-                                    detail::member_count_impl(
-                                        member_pack<T, detail::atom>{})>
+    : public std::integral_constant<
+          size_t,
+          detail::member_pack_count<T, detail::atom>::value>
+{};
+
+////////////////////
+//// member_tie ////
+////////////////////
+
+#if PYXI_CXX >= 17
+
+namespace detail
+{
+// Member lists are built ten at a time, and each member is named by its
+// two digits. Every item is led by a comma, and the first is dropped.
+#define PYXI_MEMBER_NAME(I)  m##I
+#define PYXI_MEMBER_BRACE(I) {}
+
+#define PYXI_MEMBER_UNITS_0(F, D)
+#define PYXI_MEMBER_UNITS_1(F, D)  PYXI_MEMBER_UNITS_0(F, D), F(D##0)
+#define PYXI_MEMBER_UNITS_2(F, D)  PYXI_MEMBER_UNITS_1(F, D), F(D##1)
+#define PYXI_MEMBER_UNITS_3(F, D)  PYXI_MEMBER_UNITS_2(F, D), F(D##2)
+#define PYXI_MEMBER_UNITS_4(F, D)  PYXI_MEMBER_UNITS_3(F, D), F(D##3)
+#define PYXI_MEMBER_UNITS_5(F, D)  PYXI_MEMBER_UNITS_4(F, D), F(D##4)
+#define PYXI_MEMBER_UNITS_6(F, D)  PYXI_MEMBER_UNITS_5(F, D), F(D##5)
+#define PYXI_MEMBER_UNITS_7(F, D)  PYXI_MEMBER_UNITS_6(F, D), F(D##6)
+#define PYXI_MEMBER_UNITS_8(F, D)  PYXI_MEMBER_UNITS_7(F, D), F(D##7)
+#define PYXI_MEMBER_UNITS_9(F, D)  PYXI_MEMBER_UNITS_8(F, D), F(D##8)
+#define PYXI_MEMBER_UNITS_10(F, D) PYXI_MEMBER_UNITS_9(F, D), F(D##9)
+
+#define PYXI_MEMBER_TENS_0(F)
+#define PYXI_MEMBER_TENS_1(F) PYXI_MEMBER_TENS_0(F) PYXI_MEMBER_UNITS_10(F, 0)
+#define PYXI_MEMBER_TENS_2(F) PYXI_MEMBER_TENS_1(F) PYXI_MEMBER_UNITS_10(F, 1)
+#define PYXI_MEMBER_TENS_3(F) PYXI_MEMBER_TENS_2(F) PYXI_MEMBER_UNITS_10(F, 2)
+#define PYXI_MEMBER_TENS_4(F) PYXI_MEMBER_TENS_3(F) PYXI_MEMBER_UNITS_10(F, 3)
+#define PYXI_MEMBER_TENS_5(F) PYXI_MEMBER_TENS_4(F) PYXI_MEMBER_UNITS_10(F, 4)
+#define PYXI_MEMBER_TENS_6(F) PYXI_MEMBER_TENS_5(F) PYXI_MEMBER_UNITS_10(F, 5)
+#define PYXI_MEMBER_TENS_7(F) PYXI_MEMBER_TENS_6(F) PYXI_MEMBER_UNITS_10(F, 6)
+#define PYXI_MEMBER_TENS_8(F) PYXI_MEMBER_TENS_7(F) PYXI_MEMBER_UNITS_10(F, 7)
+#define PYXI_MEMBER_TENS_9(F) PYXI_MEMBER_TENS_8(F) PYXI_MEMBER_UNITS_10(F, 8)
+
+#define PYXI_MEMBER_REST(...)     PYXI_MEMBER_REST_(__VA_ARGS__)
+#define PYXI_MEMBER_REST_(_, ...) __VA_ARGS__
+#define PYXI_MEMBER_LIST(F, A, B) \
+	PYXI_MEMBER_REST(PYXI_MEMBER_TENS_##A(F) PYXI_MEMBER_UNITS_##B(F, A))
+
+	template <typename T, size_t N, typename = void>
+	struct member_tie_probe : public std::false_type
+	{};
+
+#define PYXI_MEMBER_TIE(A, B)                                                  \
+	template <typename T>                                                      \
+	auto member_tie_impl(T& t, std::integral_constant<size_t, A * 10 + B>)     \
+	{                                                                          \
+		auto& [PYXI_MEMBER_LIST(PYXI_MEMBER_NAME, A, B)] = t;                  \
+		return std::tie(PYXI_MEMBER_LIST(PYXI_MEMBER_NAME, A, B));             \
+	}                                                                          \
+                                                                               \
+	template <typename T>                                                      \
+	struct member_tie_probe<                                                   \
+	    T,                                                                     \
+	    A * 10 + B,                                                            \
+	    void_t<decltype(T{PYXI_MEMBER_LIST(PYXI_MEMBER_BRACE, A, B)})>>        \
+	    : public std::true_type                                                \
+	{};
+
+#define PYXI_MEMBER_TIES(A)                                                    \
+	PYXI_MEMBER_TIE(A, 0)                                                      \
+	PYXI_MEMBER_TIE(A, 1)                                                      \
+	PYXI_MEMBER_TIE(A, 2)                                                      \
+	PYXI_MEMBER_TIE(A, 3)                                                      \
+	PYXI_MEMBER_TIE(A, 4)                                                      \
+	PYXI_MEMBER_TIE(A, 5)                                                      \
+	PYXI_MEMBER_TIE(A, 6)                                                      \
+	PYXI_MEMBER_TIE(A, 7)                                                      \
+	PYXI_MEMBER_TIE(A, 8)                                                      \
+	PYXI_MEMBER_TIE(A, 9)
+
+	PYXI_MEMBER_TIE(0, 1)
+	PYXI_MEMBER_TIE(0, 2)
+	PYXI_MEMBER_TIE(0, 3)
+	PYXI_MEMBER_TIE(0, 4)
+	PYXI_MEMBER_TIE(0, 5)
+	PYXI_MEMBER_TIE(0, 6)
+	PYXI_MEMBER_TIE(0, 7)
+	PYXI_MEMBER_TIE(0, 8)
+	PYXI_MEMBER_TIE(0, 9)
+	PYXI_MEMBER_TIES(1)
+	PYXI_MEMBER_TIES(2)
+	PYXI_MEMBER_TIES(3)
+	PYXI_MEMBER_TIES(4)
+	PYXI_MEMBER_TIES(5)
+	PYXI_MEMBER_TIES(6)
+	PYXI_MEMBER_TIES(7)
+	PYXI_MEMBER_TIES(8)
+	PYXI_MEMBER_TIES(9)
+
+#undef PYXI_MEMBER_TIES
+#undef PYXI_MEMBER_TIE
+#undef PYXI_MEMBER_LIST
+#undef PYXI_MEMBER_REST_
+#undef PYXI_MEMBER_REST
+#undef PYXI_MEMBER_TENS_0
+#undef PYXI_MEMBER_TENS_1
+#undef PYXI_MEMBER_TENS_2
+#undef PYXI_MEMBER_TENS_3
+#undef PYXI_MEMBER_TENS_4
+#undef PYXI_MEMBER_TENS_5
+#undef PYXI_MEMBER_TENS_6
+#undef PYXI_MEMBER_TENS_7
+#undef PYXI_MEMBER_TENS_8
+#undef PYXI_MEMBER_TENS_9
+#undef PYXI_MEMBER_UNITS_0
+#undef PYXI_MEMBER_UNITS_1
+#undef PYXI_MEMBER_UNITS_2
+#undef PYXI_MEMBER_UNITS_3
+#undef PYXI_MEMBER_UNITS_4
+#undef PYXI_MEMBER_UNITS_5
+#undef PYXI_MEMBER_UNITS_6
+#undef PYXI_MEMBER_UNITS_7
+#undef PYXI_MEMBER_UNITS_8
+#undef PYXI_MEMBER_UNITS_9
+#undef PYXI_MEMBER_UNITS_10
+#undef PYXI_MEMBER_BRACE
+#undef PYXI_MEMBER_NAME
+
+} // namespace detail
+
+// Members are counted with brace elision, which splits C arrays into their
+// elements; structured bindings do not, so such types are rejected by
+// requiring the same count to work with one braced list per member. Types
+// with more than 99 members are not tied either, and take the same paths as
+// under C++14.
+template <typename T>
+struct is_member_tieable
+    : public detail::member_tie_probe<
+          typename std::remove_const<T>::type,
+          member_count<typename std::remove_const<T>::type>::value>
 {};
 
+template <typename T>
+auto member_tie(T& t)
+{
+	static_assert(is_member_tieable<T>::value,
+	              "Members of this type cannot be bound");
+
+	return detail::member_tie_impl(
+	    t,
+	    std::integral_constant<
+	        size_t,
+	        member_count<typename std::remove_const<T>::type>::value>{});
+}
+
+#endif
+
 ////////////////////////
 //// member_offsets ////
 ////////////////////////
@@ -624,7 +1462,7 @@ namespace detail
 	struct atom_offset_binder
 	{
 		template <typename T>
-		operator T() const noexcept
+		operator T() noexcept
 		{
 			base    = (base + alignof(T) - 1) / alignof(T) * alignof(T);
 			offset  = base;
@@ -648,17 +1486,63 @@ namespace detail
 	}
 } // namespace detail
 
-template <typename T>
+#if PYXI_CXX >= 17
+namespace detail
+{
+	template <typename... Ts>
+	constexpr std::array<size_t, sizeof...(Ts)> member_offsets_impl(
+	    std::tuple<Ts&...>*) noexcept
+	{
+		constexpr size_t sizes[]      = {sizeof(Ts)...};
+		constexpr size_t alignments[] = {alignof(Ts)...};
+
+		std::array<size_t, sizeof...(Ts)> offsets{};
+		size_t base = 0;
+
+		for (size_t i = 0; i < sizeof...(Ts); ++i)
+		{
+			base        = (base + alignments[i] - 1) / alignments[i] *
+			              alignments[i];
+			offsets[i]  = base;
+			base       += sizes[i];
+		}
+
+		return offsets;
+	}
+} // namespace detail
+#endif
+
+template <typename T, typename = void>
 struct member_offsets
 {
-	static auto value() noexcept -> decltype(detail::member_offsets_impl<T>(
-	    make_sequence<member_count<T>::value>{}))
+	static std::array<size_t, member_count<T>::value> value() noexcept
 	{
-		return detail::member_offsets_impl<T>(
+		static const auto offsets = detail::member_offsets_impl<T>(
 		    make_sequence<member_count<T>::value>{});
+		return offsets;
+	}
+};
+
+#if PYXI_CXX >= 17
+template <typename T>
+struct member_offsets<T, enable_if_t<is_member_tieable<T>::value>>
+{
+	static constexpr std::array<size_t, member_count<T>::value> table =
+	    detail::member_offsets_impl(
+	        static_cast<decltype(member_tie(std::declval<T&>()))*>(nullptr));
+
+	static constexpr std::array<size_t, member_count<T>::value> value() noexcept
+	{
+		return table;
 	}
 };
 
+template <typename T, size_t I>
+struct member_offset
+    : public std::integral_constant<size_t, member_offsets<T>::table[I]>
+{};
+#endif
+
 ////////////////////////////
 //// member_serializers ////
 ////////////////////////////
@@ -670,7 +1554,7 @@ namespace detail
 	struct atom_serializer_binder
 	{
 		template <typename T>
-		operator T() const noexcept
+		operator T() noexcept
 		{
 			*serializer =
 			    [](const void* pData, size_t offset, Serializer& ser) {
@@ -716,7 +1600,7 @@ namespace detail
 	struct atom_deserializer_binder
 	{
 		template <typename T>
-		operator T() const noexcept
+		operator T() noexcept
 		{
 			*deserializer = [](void* pData, size_t offset, Deserializer& des) {
 				des.get(*reinterpret_cast<T*>(static_cast<uint8_t*>(pData) +
@@ -755,6 +1639,43 @@ struct member_deserializers
 //// Member Policy ////
 ///////////////////////
 
+namespace detail
+{
+	struct atom_put_binder
+	{
+		template <typename T>
+		operator T()
+		{
+			base = (base + alignof(T) - 1) / alignof(T) * alignof(T);
+			ser.put(*reinterpret_cast<const T*>(pData + base));
+			base += sizeof(T);
+
+			return {};
+		}
+
+		const uint8_t* pData;
+		size_t& base;
+		Serializer& ser;
+	};
+
+	struct atom_get_binder
+	{
+		template <typename T>
+		operator T()
+		{
+			base = (base + alignof(T) - 1) / alignof(T) * alignof(T);
+			des.get(*reinterpret_cast<T*>(pData + base));
+			base += sizeof(T);
+
+			return {};
+		}
+
+		uint8_t* pData;
+		size_t& base;
+		Deserializer& des;
+	};
+} // namespace detail
+
 template <typename T>
 struct Policy<
     T,
@@ -764,32 +1685,166 @@ struct Policy<
 {
 	static void serialize(const T& t, Serializer& ser)
 	{
-		auto offsets     = member_offsets<T>::value();
-		auto serializers = member_serializers<T>::value();
+		serialize(t, ser, make_sequence<member_count<T>::value>{});
+	}
+
+	static void deserialize(T& t, Deserializer& des)
+	{
+		deserialize(t, des, make_sequence<member_count<T>::value>{});
+	}
 
-		for (size_t i = 0; i < offsets.size(); ++i)
+private:
+#if PYXI_CXX >= 17
+	template <size_t... Is>
+	static void serialize(const T& t, Serializer& ser, sequence<Is...> seq)
+	{
+		if constexpr (is_member_tieable<T>::value)
 		{
-			serializers[i](&t, offsets[i], ser);
+			auto members = member_tie(t);
+			(ser.put(std::get<Is>(members)), ...);
+		}
+		else
+		{
+			bind(t, ser, seq);
 		}
 	}
 
-	static void deserialize(T& t, Deserializer& des)
+	template <size_t... Is>
+	static void deserialize(T& t, Deserializer& des, sequence<Is...> seq)
 	{
-		auto offsets       = member_offsets<T>::value();
-		auto deserializers = member_deserializers<T>::value();
-
-		for (size_t i = 0; i < offsets.size(); ++i)
+		if constexpr (is_member_tieable<T>::value)
 		{
-			deserializers[i](&t, offsets[i], des);
+			auto members = member_tie(t);
+			(des.get(std::get<Is>(members)), ...);
+		}
+		else
+		{
+			bind(t, des, seq);
 		}
 	}
-};
+#else
+	template <size_t... Is>
+	static void serialize(const T& t, Serializer& ser, sequence<Is...> seq)
+	{
+		bind(t, ser, seq);
+	}
 
-//////////////
-//// Bits ////
-//////////////
+	template <size_t... Is>
+	static void deserialize(T& t, Deserializer& des, sequence<Is...> seq)
+	{
+		bind(t, des, seq);
+	}
+#endif
 
-template <typename T, size_t Width, typename = void>
+	// Each binder serializes the member it is converted to as the scratch
+	// object is aggregate initialized, left to right, with the offset kept
+	// in a local the compiler can fold away.
+	template <size_t... Is>
+	static void bind(const T& t, Serializer& ser, sequence<Is...>)
+	{
+		size_t base = 0;
+		T{detail::atom_put_binder{
+		    (static_cast<void>(Is), reinterpret_cast<const uint8_t*>(&t)),
+		    base,
+		    ser}...};
+	}
+
+	template <size_t... Is>
+	static void bind(T& t, Deserializer& des, sequence<Is...>)
+	{
+		size_t base = 0;
+		T{detail::atom_get_binder{
+		    (static_cast<void>(Is), reinterpret_cast<uint8_t*>(&t)),
+		    base,
+		    des}...};
+	}
+};
+
+#if PYXI_CXX >= 17
+
+namespace detail
+{
+	template <typename T>
+	struct is_bulk_member
+	    : public std::conjunction<std::is_arithmetic<T>,
+	                              std::negation<std::is_const<T>>,
+	                              bulk_elements<T>>
+	{};
+
+	template <typename Tie>
+	struct bulk_members : public std::false_type
+	{};
+
+	template <typename M, typename... Ms>
+	struct bulk_members<std::tuple<M&, Ms&...>>
+	    : public std::integral_constant<
+	          bool,
+	          is_bulk_member<M>::value &&
+	              ((is_bulk_member<Ms>::value && sizeof(Ms) == sizeof(M)) &&
+	               ...)>
+	{
+		static constexpr size_t width = sizeof(M);
+		static constexpr size_t count = 1 + sizeof...(Ms);
+	};
+
+	template <typename T, typename = void>
+	struct bulk_struct : public std::false_type
+	{};
+
+	// Checked cheapest first, so that other element types are never
+	// counted or tied.
+	template <typename T>
+	struct bulk_struct<
+	    T,
+	    enable_if_t<std::conjunction<std::is_class<T>,
+	                                 std::is_aggregate<T>,
+	                                 std::is_trivially_copyable<T>,
+	                                 std::is_standard_layout<T>,
+	                                 is_member_tieable<T>,
+	                                 uses_policy<T, Priority::Secondary>>::value>>
+	    : public bulk_members<decltype(member_tie(std::declval<T&>()))>
+	{};
+
+	// Structs of numbers of one width with no padding encode as a run of
+	// their members, member by member and element by element.
+	template <typename T>
+	struct bulk_elements<
+	    T,
+	    enable_if_t<bulk_struct<T>::value &&
+	                sizeof(T) == bulk_struct<T>::width * bulk_struct<T>::count>>
+	    : public std::true_type
+	{
+		using E = typename std::conditional<
+		    bulk_struct<T>::width == 1,
+		    uint8_t,
+		    typename std::conditional<
+		        bulk_struct<T>::width == 2,
+		        uint16_t,
+		        typename std::conditional<bulk_struct<T>::width == 4,
+		                                  uint32_t,
+		                                  uint64_t>::type>::type>::type;
+
+		static constexpr size_t count = bulk_struct<T>::count;
+
+		static void put(const T* p, size_t n, Serializer& ser)
+		{
+			ser.give_many(reinterpret_cast<const E*>(p), n * count);
+		}
+
+		static void get(T* p, size_t n, Deserializer& des)
+		{
+			des.take_many(reinterpret_cast<E*>(p), n * count);
+		}
+	};
+} // namespace detail
+
+#endif
+
+//////////////
+//// Bits ////
+//////////////
+
+template <typename T, size_t Width, typename = void>
 class Bits
 {
 public:
@@ -879,316 +1934,3898 @@ struct Policy<Spare<Width>, void, Priority::Primary>
 	}
 };
 
-////////////////////
-//// Byte Order ////
-////////////////////
+//////////////
+//// Half ////
+//////////////
 
-enum class ByteOrder
+namespace detail
 {
-	MsbFirst,
-	LsbFirst
-};
+	// IEEE binary16, rounding to nearest even.
+	inline uint16_t float_to_half(float f) noexcept
+	{
+		uint32_t x;
+		std::memcpy(&x, &f, sizeof(x));
 
-/////////////////////////////
-//// Bytewise Serializer ////
-/////////////////////////////
+		const uint16_t sign = static_cast<uint16_t>((x >> 16) & 0x8000);
+		const uint32_t abs  = x & 0x7fffffff;
 
-class BytewiseSerializer : public Serializer
-{
-public:
-	BytewiseSerializer(ByteOrder byteOrder) noexcept;
+		if (abs >= 0x7f800000)
+		{
+			// Infinity stays infinity; NaNs stay quiet NaNs.
+			const uint32_t nan = abs > 0x7f800000 ? 0x200 | abs >> 13 : 0;
+			return static_cast<uint16_t>(sign | 0x7c00 | (nan & 0x3ff));
+		}
+		else if (abs >= 0x477ff000)
+		{
+			return static_cast<uint16_t>(sign | 0x7c00);
+		}
+		else if (abs >= 0x38800000)
+		{
+			uint32_t h           = (abs - 0x38000000) >> 13;
+			const uint32_t round = abs & 0x1fff;
 
-	void flush();
+			h += round > 0x1000 || (round == 0x1000 && (h & 1));
+			return static_cast<uint16_t>(sign | h);
+		}
+		else if (abs < 0x33000000)
+		{
+			return sign;
+		}
 
-protected:
-	virtual void putByte(uint8_t byte) = 0;
+		const uint32_t shift    = 126 - (abs >> 23);
+		const uint32_t mantissa = (abs & 0x7fffff) | 0x800000;
+		const uint32_t half     = 1u << (shift - 1);
+		const uint32_t round    = mantissa & ((1u << shift) - 1);
 
-	void impl(size_t data, size_t bits) override;
+		uint32_t h = mantissa >> shift;
+		h += round > half || (round == half && (h & 1));
+		return static_cast<uint16_t>(sign | h);
+	}
 
-private:
-	ByteOrder byteOrder_;
-	uint8_t byte_    = 0;
-	uint8_t bitsSet_ = 0;
-};
+	inline float half_to_float(uint16_t h) noexcept
+	{
+		const uint32_t sign = static_cast<uint32_t>(h & 0x8000) << 16;
+		uint32_t exponent   = (h >> 10) & 0x1f;
+		uint32_t mantissa   = h & 0x3ff;
 
-inline BytewiseSerializer::BytewiseSerializer(ByteOrder byteOrder) noexcept
-    : byteOrder_(byteOrder)
-{}
+		uint32_t x;
+		if (exponent == 0x1f)
+		{
+			const uint32_t quiet = mantissa != 0 ? 0x400000 : 0;
+			x = sign | 0x7f800000 | quiet | mantissa << 13;
+		}
+		else if (exponent != 0)
+		{
+			x = sign | (exponent + 112) << 23 | mantissa << 13;
+		}
+		else if (mantissa == 0)
+		{
+			x = sign;
+		}
+		else
+		{
+			for (exponent = 113; (mantissa & 0x400) == 0; --exponent)
+			{
+				mantissa <<= 1;
+			}
 
-inline void BytewiseSerializer::flush()
-{
-	if (bitsSet_ != 0)
-	{
-		putByte(byte_);
-		byte_    = 0;
-		bitsSet_ = 0;
-	}
-}
+			x = sign | exponent << 23 | (mantissa & 0x3ff) << 13;
+		}
 
-inline void BytewiseSerializer::impl(size_t data, size_t bits)
-{
-	if (byteOrder_ == ByteOrder::MsbFirst)
-	{
-		data <<= bitsize<size_t>::value - bits;
+		float f;
+		std::memcpy(&f, &x, sizeof(f));
+		return f;
 	}
 
-	const uint8_t byteMask = byteOrder_ == ByteOrder::MsbFirst ? 0x01 : 0x80;
-	const size_t dataMask  = byteOrder_ == ByteOrder::MsbFirst
-	                             ? size_t{1} << (bitsize<size_t>::value - 1)
-	                             : 1;
-
-	while (bits--)
+	inline void floats_to_halves(const float* p, uint16_t* h, size_t count)
 	{
-		if (data & dataMask)
+		size_t i = 0;
+
+#if defined(__F16C__)
+		for (; i + 8 <= count; i += 8)
 		{
-			byte_ |= byteMask;
+			const __m128i v = _mm256_cvtps_ph(_mm256_loadu_ps(p + i),
+			                                  _MM_FROUND_TO_NEAREST_INT);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(h + i), v);
 		}
+#endif
 
-		if (++bitsSet_ == bitsize<>::value)
+		for (; i < count; ++i)
 		{
-			putByte(byte_);
-			byte_    = 0;
-			bitsSet_ = 0;
+			h[i] = float_to_half(p[i]);
 		}
+	}
 
-		if (byteOrder_ == ByteOrder::MsbFirst)
+	inline void halves_to_floats(const uint16_t* h, float* p, size_t count)
+	{
+		size_t i = 0;
+
+#if defined(__F16C__)
+		for (; i + 8 <= count; i += 8)
 		{
-			byte_ <<= 1;
-			data  <<= 1;
+			const __m128i v =
+			    _mm_loadu_si128(reinterpret_cast<const __m128i*>(h + i));
+			_mm256_storeu_ps(p + i, _mm256_cvtph_ps(v));
 		}
-		else
+#endif
+
+		for (; i < count; ++i)
 		{
-			byte_ >>= 1;
-			data  >>= 1;
+			p[i] = half_to_float(h[i]);
 		}
 	}
-}
-
-///////////////////////////////
-//// Bytewise Deserializer ////
-///////////////////////////////
+} // namespace detail
 
-class BytewiseDeserializer : public Deserializer
+template <typename T>
+class Half
 {
+	static_assert(std::is_floating_point<T>::value,
+	              "Half requires a floating point type");
+
 public:
-	BytewiseDeserializer(ByteOrder byteOrder) noexcept;
+	Half() noexcept = default;
+	Half(T value) noexcept;
 
-protected:
-	virtual uint8_t getByte() = 0;
+	T& operator*() noexcept { return value; }
 
-	void impl(size_t& data, size_t bits, bool signExtend) override;
+	T operator*() const noexcept { return value; }
+
+	Half& operator=(T value) noexcept
+	{
+		this->value = value;
+		return *this;
+	}
 
 private:
-	ByteOrder byteOrder_;
-	uint8_t byte_;
-	uint8_t bitsLeft_ = 0;
+	T value;
 };
 
-inline BytewiseDeserializer::BytewiseDeserializer(ByteOrder byteOrder) noexcept
-    : byteOrder_(byteOrder)
+template <typename T>
+Half<T>::Half(T value) noexcept
+    : value(value)
 {}
 
-inline void BytewiseDeserializer::impl(size_t& data,
-                                       size_t bits,
-                                       bool signExtend)
+template <typename T>
+struct Policy<Half<T>, void, Priority::Primary>
 {
-	size_t signMask = -1;
+	static void serialize(const Half<T>& t, Serializer& ser)
+	{
+		ser.give(detail::float_to_half(static_cast<float>(*t)));
+	}
 
-	const uint8_t byteMask = byteOrder_ == ByteOrder::LsbFirst ? 0x01 : 0x80;
-	const size_t dataMask  = byteOrder_ == ByteOrder::LsbFirst
-	                             ? size_t{1} << (bitsize<size_t>::value - 1)
-	                             : 1;
+	static void deserialize(Half<T>& t, Deserializer& des)
+	{
+		*t = detail::half_to_float(des.take<uint16_t>());
+	}
+};
 
-	for (size_t i = bits; i > 0; --i)
+namespace detail
+{
+	// Runs of Half<float> are converted a block at a time, eight lanes at
+	// once where F16C is available.
+	template <>
+	struct bulk_elements<Half<float>> : public std::true_type
 	{
-		if (byteOrder_ == ByteOrder::LsbFirst)
-		{
-			byte_    >>= 1;
-			data     >>= 1;
-			signMask >>= 1;
-		}
-		else
-		{
-			byte_    <<= 1;
-			data     <<= 1;
-			signMask <<= 1;
-		}
+		static_assert(sizeof(Half<float>) == sizeof(float),
+		              "Half<float> must have the layout of float");
 
-		if (bitsLeft_-- == 0)
+		static void put(const Half<float>* p, size_t count, Serializer& ser)
 		{
-			byte_     = getByte();
-			bitsLeft_ = bitsize<>::value - 1;
+			const float* values = reinterpret_cast<const float*>(p);
+			uint16_t buffer[256];
+
+			while (count != 0)
+			{
+				const size_t n = count < 256 ? count : 256;
+
+				floats_to_halves(values, buffer, n);
+				ser.give_many(buffer, n);
+
+				values += n;
+				count -= n;
+			}
 		}
 
-		if (byte_ & byteMask)
+		static void get(Half<float>* p, size_t count, Deserializer& des)
 		{
-			data |= dataMask;
+			float* values = reinterpret_cast<float*>(p);
+			uint16_t buffer[256];
+
+			while (count != 0)
+			{
+				const size_t n = count < 256 ? count : 256;
+
+				des.take_many(buffer, n);
+				halves_to_floats(buffer, values, n);
+
+				values += n;
+				count -= n;
+			}
 		}
-	}
+	};
+} // namespace detail
 
-	if (byteOrder_ == ByteOrder::LsbFirst)
+///////////////////
+//// Quantized ////
+///////////////////
+
+// Stores a value in [Min, Max] (std::ratio bounds) as one of the 2^Width
+// evenly spaced steps across that range. Values outside it are clamped.
+template <typename T, size_t Width, typename Min, typename Max>
+class Quantized
+{
+	static_assert(std::is_floating_point<T>::value,
+	              "Quantized requires a floating point type");
+	static_assert(Width > 0 && Width <= 32,
+	              "Quantized width must be between 1 and 32 bits");
+	static_assert(std::ratio_less<Min, Max>::value,
+	              "Quantized range must not be empty");
+
+public:
+	enum
 	{
-		data     >>= bitsize<size_t>::value - bits;
-		signMask   = ~signMask;
-	}
+		bitwidth = Width
+	};
 
-	if (signExtend)
+	Quantized() noexcept = default;
+	Quantized(T value) noexcept;
+
+	T& operator*() noexcept { return value; }
+
+	T operator*() const noexcept { return value; }
+
+	Quantized& operator=(T value) noexcept
 	{
-		data |= signMask;
+		this->value = value;
+		return *this;
 	}
-}
-
-////////////////////////////
-//// Dynamic Serializer ////
-////////////////////////////
 
-class DynamicSerializer : public BytewiseSerializer
-{
-public:
-	DynamicSerializer(ByteOrder byteOrder) noexcept;
+	static constexpr double min() noexcept
+	{
+		return static_cast<double>(Min::num) / Min::den;
+	}
 
-	const std::vector<uint8_t>& data() const noexcept { return bytes; }
+	static constexpr double max() noexcept
+	{
+		return static_cast<double>(Max::num) / Max::den;
+	}
 
-protected:
-	void putByte(uint8_t byte) override;
+	// Distance between neighbouring steps; decoding is off by at most half.
+	static constexpr double step() noexcept
+	{
+		return (max() - min()) / ((uint64_t{1} << Width) - 1);
+	}
 
 private:
-	std::vector<uint8_t> bytes;
+	T value;
 };
 
-inline DynamicSerializer::DynamicSerializer(ByteOrder byteOrder) noexcept
-    : BytewiseSerializer(byteOrder)
+template <typename T, size_t Width, typename Min, typename Max>
+Quantized<T, Width, Min, Max>::Quantized(T value) noexcept
+    : value(value)
 {}
 
-inline void DynamicSerializer::putByte(uint8_t byte)
+template <typename T, size_t Width, typename Min, typename Max>
+struct Policy<Quantized<T, Width, Min, Max>, void, Priority::Primary>
 {
-	bytes.push_back(byte);
-}
+	using Q = Quantized<T, Width, Min, Max>;
 
+	static void serialize(const Q& t, Serializer& ser)
+	{
+		const double v = static_cast<double>(*t);
+		uint32_t q     = 0;
+
+		// Written so that NaN lands on the minimum.
+		if (v >= Q::max())
+		{
+			q = static_cast<uint32_t>((uint64_t{1} << Width) - 1);
+		}
+		else if (v > Q::min())
+		{
+			q = static_cast<uint32_t>((v - Q::min()) / Q::step() + 0.5);
+		}
+
+		ser.give(q, Width);
+	}
+
+	static void deserialize(Q& t, Deserializer& des)
+	{
+		const uint32_t q = des.take<uint32_t>(Width);
+
+		*t = static_cast<T>(Q::min() + q * Q::step());
+	}
+};
+
+///////////////
+//// Align ////
+///////////////
+
+// Pads the stream with zero bits up to the next multiple of Width bits, so
+// that what follows, such as a large array after a few Bits, starts on a
+// boundary. Align<8> puts the next field on a byte.
+template <size_t Width>
+struct Align
+{
+	static_assert(Width > 0, "Instantiation of Align is empty");
+};
+
+template <size_t Width>
+struct Policy<Align<Width>, void, Priority::Primary>
+{
+	static void serialize(const Align<Width>&, Serializer& ser)
+	{
+		ser.align(Width);
+	}
+
+	static void deserialize(const Align<Width>&, Deserializer& des)
+	{
+		des.align(Width);
+	}
+};
+
+/////////////////
+//// Natural ////
+/////////////////
+
+namespace detail
+{
+	template <typename T>
+	void natural_mask(uint8_t* mask) noexcept;
+
+	struct atom_mask_binder
+	{
+		template <typename T>
+		operator T() noexcept
+		{
+			base = (base + alignof(T) - 1) / alignof(T) * alignof(T);
+			natural_mask<T>(mask + base);
+			base += sizeof(T);
+
+			return {};
+		}
+
+		uint8_t* mask;
+		size_t& base;
+	};
+
+	template <typename T, size_t... Is>
+	void natural_mask(uint8_t* mask, sequence<Is...>, std::true_type) noexcept
+	{
+		size_t base = 0;
+		T{typename repeat<atom_mask_binder, Is>::type{mask, base}...};
+	}
+
+	template <typename T, size_t... Is>
+	void natural_mask(uint8_t* mask, sequence<Is...>, std::false_type) noexcept
+	{
+		std::memset(mask, 0xff, sizeof(T));
+	}
+
+	// Marks the bytes of T that hold members, leaving its padding clear.
+	template <typename T>
+	void natural_mask(uint8_t* mask) noexcept
+	{
+		natural_mask<T>(
+		    mask,
+		    make_sequence<member_count<T>::value>{},
+		    std::integral_constant<bool, (member_count<T>::value > 1)>{});
+	}
+
+	template <typename T>
+	const std::array<uint8_t, sizeof(T)>& natural_mask_table() noexcept
+	{
+		static const std::array<uint8_t, sizeof(T)> table = []() {
+			std::array<uint8_t, sizeof(T)> mask{};
+			natural_mask<T>(mask.data());
+			return mask;
+		}();
+
+		return table;
+	}
+
+	// Writes the memory image of count Ts, with their padding zeroed.
+	template <typename T>
+	void put_natural(const T* p, size_t count, Serializer& ser)
+	{
+		const auto& mask = natural_mask_table<T>();
+
+		if (std::all_of(mask.begin(), mask.end(), [](uint8_t m) {
+			    return m == 0xff;
+		    }))
+		{
+			ser.write_bytes(p, count * sizeof(T));
+			return;
+		}
+
+		uint8_t image[sizeof(T)];
+		for (size_t i = 0; i < count; ++i)
+		{
+			std::memcpy(image, p + i, sizeof(T));
+			for (size_t j = 0; j < sizeof(T); ++j)
+			{
+				image[j] &= mask[j];
+			}
+
+			ser.write_bytes(image, sizeof(T));
+		}
+	}
+
+	template <size_t Alignment>
+	void put_natural_padding(Serializer& ser)
+	{
+		ser.align(Alignment * bitsize<>::value);
+	}
+
+	template <size_t Alignment>
+	void get_natural_padding(Deserializer& des)
+	{
+		des.align(Alignment * bitsize<>::value);
+	}
+} // namespace detail
+
+// Lays a trivially copyable value, or a vector of them, out as in memory:
+// padded to its alignment from the start of the stream, in host byte order,
+// with padding bytes zeroed. A buffer of such data, such as a mapped file,
+// can then be read in place through NaturalReader.
+template <typename T>
+class Natural
+{
+public:
+	Natural() = default;
+	Natural(T value);
+
+	T& operator*() noexcept { return value; }
+
+	const T& operator*() const noexcept { return value; }
+
+	T* operator->() noexcept { return &value; }
+
+	const T* operator->() const noexcept { return &value; }
+
+private:
+	T value;
+};
+
+template <typename T>
+Natural<T>::Natural(T value)
+    : value(std::move(value))
+{}
+
+template <typename T>
+struct Policy<Natural<T>, void, Priority::Primary>
+{
+	static void serialize(const Natural<T>& t, Serializer& ser)
+	{
+		serialize(*t, ser, std::is_trivially_copyable<T>{});
+	}
+
+	static void deserialize(Natural<T>& t, Deserializer& des)
+	{
+		deserialize(*t, des, std::is_trivially_copyable<T>{});
+	}
+
+private:
+	static void serialize(const T& t, Serializer& ser, std::true_type)
+	{
+		detail::put_natural_padding<alignof(T)>(ser);
+		detail::put_natural(&t, 1, ser);
+	}
+
+	static void deserialize(T& t, Deserializer& des, std::true_type)
+	{
+		detail::get_natural_padding<alignof(T)>(des);
+		des.read_bytes(&t, sizeof(T));
+	}
+
+	static void serialize(const T& t, Serializer& ser, std::false_type)
+	{
+		using V = typename T::value_type;
+		check<V>();
+
+		const uint64_t size = t.size();
+		detail::put_natural_padding<alignof(uint64_t)>(ser);
+		detail::put_natural(&size, 1, ser);
+
+		detail::put_natural_padding<alignof(V)>(ser);
+		detail::put_natural(t.data(), t.size(), ser);
+	}
+
+	static void deserialize(T& t, Deserializer& des, std::false_type)
+	{
+		using V = typename T::value_type;
+		check<V>();
+
+		uint64_t size;
+		detail::get_natural_padding<alignof(uint64_t)>(des);
+		des.read_bytes(&size, sizeof(size));
+
+		t.resize(size);
+
+		detail::get_natural_padding<alignof(V)>(des);
+		des.read_bytes(t.data(), t.size() * sizeof(V));
+	}
+
+	template <typename V>
+	static void check() noexcept
+	{
+		static_assert(is_contiguous<T>::value && is_resizable<T>::value &&
+		                  std::is_trivially_copyable<V>::value,
+		              "Natural requires a trivially copyable type or a "
+		              "vector of them");
+	}
+};
+
+// Reads data written through Natural straight out of a buffer, returning
+// references into it instead of copies. The buffer must start at the start
+// of the stream and be aligned at least as strictly as the types read; page
+// aligned mappings and allocations are.
+class NaturalReader
+{
+public:
+	NaturalReader(const void* data, size_t size) noexcept;
+
+	template <typename T>
+	const T& next();
+
+	// Elements and length of a vector written as Natural<std::vector<T>>.
+	template <typename T>
+	std::pair<const T*, size_t> next_array();
+
+	size_t tell() const noexcept { return offset_; }
+
+private:
+	const uint8_t* at(size_t alignment, size_t size);
+
+	const uint8_t* data_;
+	size_t size_;
+	size_t offset_ = 0;
+};
+
+inline NaturalReader::NaturalReader(const void* data, size_t size) noexcept
+    : data_(static_cast<const uint8_t*>(data)),
+      size_(size)
+{}
+
+template <typename T>
+const T& NaturalReader::next()
+{
+	static_assert(std::is_trivially_copyable<T>::value,
+	              "NaturalReader requires a trivially copyable type");
+
+	return *reinterpret_cast<const T*>(at(alignof(T), sizeof(T)));
+}
+
+template <typename T>
+std::pair<const T*, size_t> NaturalReader::next_array()
+{
+	static_assert(std::is_trivially_copyable<T>::value,
+	              "NaturalReader requires a trivially copyable type");
+
+	const uint64_t size = next<uint64_t>();
+	if (size > (size_ - offset_) / sizeof(T))
+	{
+		throw std::out_of_range("Natural reader out of range");
+	}
+
+	const size_t count = static_cast<size_t>(size);
+	const T* p = reinterpret_cast<const T*>(at(alignof(T), count * sizeof(T)));
+
+	return std::make_pair(p, count);
+}
+
+inline const uint8_t* NaturalReader::at(size_t alignment, size_t size)
+{
+	const size_t offset = (offset_ + alignment - 1) / alignment * alignment;
+	if (offset > size_ || size > size_ - offset)
+	{
+		throw std::out_of_range("Natural reader out of range");
+	}
+
+	const uint8_t* p = data_ + offset;
+	if (reinterpret_cast<uintptr_t>(p) % alignment != 0)
+	{
+		throw std::invalid_argument("Natural data is misaligned in memory");
+	}
+
+	offset_ = offset + size;
+	return p;
+}
+
+/////////////////////
+//// Pair Policy ////
+/////////////////////
+
+template <typename T0, typename T1>
+struct Policy<std::pair<T0, T1>, void, Priority::Primary>
+{
+	static void serialize(const std::pair<T0, T1>& t, Serializer& ser)
+	{
+		ser.put(t.first);
+		ser.put(t.second);
+	}
+
+	static void deserialize(std::pair<T0, T1>& t, Deserializer& des)
+	{
+		des.get(t.first);
+		des.get(t.second);
+	}
+};
+
+//////////////////////
+//// Tuple Policy ////
+//////////////////////
+
+template <typename... Ts>
+struct Policy<std::tuple<Ts...>, void, Priority::Primary>
+{
+	static void serialize(const std::tuple<Ts...>& t, Serializer& ser)
+	{
+		serialize(t, ser, make_sequence<sizeof...(Ts)>{});
+	}
+
+	static void deserialize(std::tuple<Ts...>& t, Deserializer& des)
+	{
+		deserialize(t, des, make_sequence<sizeof...(Ts)>{});
+	}
+
+private:
+	template <size_t... Is>
+	static void serialize(const std::tuple<Ts...>& t,
+	                      Serializer& ser,
+	                      sequence<Is...>)
+	{
+		using expand = int[];
+		(void)expand{0, (ser.put(std::get<Is>(t)), 0)...};
+	}
+
+	template <size_t... Is>
+	static void deserialize(std::tuple<Ts...>& t,
+	                        Deserializer& des,
+	                        sequence<Is...>)
+	{
+		using expand = int[];
+		(void)expand{0, (des.get(std::get<Is>(t)), 0)...};
+	}
+};
+
+//////////////////////////////
+//// count_trailing_zeros ////
+//////////////////////////////
+
+namespace detail
+{
+	inline size_t count_trailing_zeros(uint64_t v) noexcept
+	{
+#if defined(__GNUC__) || defined(__clang__)
+		return static_cast<size_t>(
+		    __builtin_ctzll(static_cast<unsigned long long>(v)));
+#else
+		size_t count = 0;
+		for (; (v & 1) == 0; v >>= 1)
+		{
+			++count;
+		}
+
+		return count;
+#endif
+	}
+} // namespace detail
+
+/////////////////////////////
+//// count_leading_zeros ////
 /////////////////////////////
-//// Buffer Deserializer ////
-/////////////////////////////
 
-class BufferDeserializer : public BytewiseDeserializer
+namespace detail
+{
+	inline size_t count_leading_zeros(uint64_t v) noexcept
+	{
+#if defined(__GNUC__) || defined(__clang__)
+		return static_cast<size_t>(
+		    __builtin_clzll(static_cast<unsigned long long>(v)));
+#else
+		size_t count = 0;
+		for (; (v & uint64_t{1} << 63) == 0; v <<= 1)
+		{
+			++count;
+		}
+
+		return count;
+#endif
+	}
+} // namespace detail
+
+/////////////////////
+//// Time Series ////
+/////////////////////
+
+// A collection of floats written as in Facebook's Gorilla: each value is
+// XORed with the one before, and only the bits that differ are stored.
+template <typename T>
+class TimeSeries
+{
+public:
+	TimeSeries() = default;
+	TimeSeries(T value);
+
+	T& operator*() noexcept { return value; }
+
+	const T& operator*() const noexcept { return value; }
+
+	T* operator->() noexcept { return &value; }
+
+	const T* operator->() const noexcept { return &value; }
+
+private:
+	T value;
+};
+
+template <typename T>
+TimeSeries<T>::TimeSeries(T value)
+    : value(std::move(value))
+{}
+
+template <typename T>
+struct Policy<TimeSeries<T>, void, Priority::Primary>
+{
+	using V = typename T::value_type;
+	using U = typename floating_width_equivalent<V>::type;
+
+	static_assert(is_resizable<T>::value && is_iterable<T>::value,
+	              "TimeSeries requires a resizable collection of floats");
+
+	static constexpr size_t width = bitsize<U>::value;
+
+	static void serialize(const TimeSeries<T>& t, Serializer& ser)
+	{
+		ser.put(t->size());
+
+		auto it = t->begin();
+		if (it == t->end())
+		{
+			return;
+		}
+
+		U prev = bits(*it);
+		ser.give(prev);
+
+		// The window of meaningful bits left over from the last value that
+		// changed; none until one has.
+		size_t leading  = width;
+		size_t trailing = 0;
+
+		for (++it; it != t->end(); ++it)
+		{
+			const U curr = bits(*it);
+			const U x    = curr ^ prev;
+			prev         = curr;
+
+			if (x == 0)
+			{
+				ser.give<uint8_t>(0, 1);
+				continue;
+			}
+
+			size_t lz = detail::count_leading_zeros(x) - (64 - width);
+			size_t tz = detail::count_trailing_zeros(x);
+
+			// The leading count has 5 bits, so larger ones widen the window.
+			lz = lz < 31 ? lz : 31;
+
+			// Unlike Gorilla, a window much wider than needed is replaced, so
+			// one outlier does not bloat every value after it.
+			if (lz >= leading && tz >= trailing &&
+			    lz - leading + tz - trailing <= 11)
+			{
+				ser.give<uint8_t>(2, 2);
+				ser.give<U>(x >> trailing, width - leading - trailing);
+				continue;
+			}
+
+			const size_t length = width - lz - tz;
+
+			ser.give<uint8_t>(3, 2);
+			ser.give(lz, 5);
+			ser.give(length - 1, 6);
+			ser.give<U>(x >> tz, length);
+
+			leading  = lz;
+			trailing = tz;
+		}
+	}
+
+	static void deserialize(TimeSeries<T>& t, Deserializer& des)
+	{
+		decltype(t->size()) size;
+		des.get(size);
+
+		t->resize(size);
+
+		auto it = t->begin();
+		if (it == t->end())
+		{
+			return;
+		}
+
+		U prev = des.take<U>();
+		*it    = value(prev);
+
+		size_t leading  = 0;
+		size_t trailing = 0;
+
+		for (++it; it != t->end(); ++it)
+		{
+			if (des.take<uint8_t>(1) != 0)
+			{
+				if (des.take<uint8_t>(1) != 0)
+				{
+					leading             = des.take<size_t>(5);
+					const size_t length = des.take<size_t>(6) + 1;
+
+					if (length > width - leading)
+					{
+						throw std::out_of_range(
+						    "Time series value exceeds its width");
+					}
+
+					trailing = width - leading - length;
+				}
+
+				prev ^= des.take<U>(width - leading - trailing) << trailing;
+			}
+
+			*it = value(prev);
+		}
+	}
+
+private:
+	static U bits(V v) noexcept
+	{
+		U u;
+		std::memcpy(&u, &v, sizeof(u));
+		return u;
+	}
+
+	static V value(U u) noexcept
+	{
+		V v;
+		std::memcpy(&v, &u, sizeof(v));
+		return v;
+	}
+};
+
+#if PYXI_CXX >= 17
+
+/////////////////////////
+//// Optional Policy ////
+/////////////////////////
+
+template <typename T>
+struct Policy<std::optional<T>, void, Priority::Primary>
+{
+	static void serialize(const std::optional<T>& t, Serializer& ser)
+	{
+		ser.give(t.has_value(), 1);
+
+		if (t)
+		{
+			ser.put(*t);
+		}
+	}
+
+	static void deserialize(std::optional<T>& t, Deserializer& des)
+	{
+		if (des.take<bool>(1))
+		{
+			if (!t)
+			{
+				t.emplace();
+			}
+
+			des.get(*t);
+		}
+		else
+		{
+			t.reset();
+		}
+	}
+};
+
+////////////////////////
+//// Variant Policy ////
+////////////////////////
+
+namespace detail
+{
+	constexpr size_t tag_bits(size_t count) noexcept
+	{
+		return count <= 1 ? 0 : 1 + tag_bits((count + 1) / 2);
+	}
+} // namespace detail
+
+template <typename... Ts>
+struct Policy<std::variant<Ts...>, void, Priority::Primary>
+{
+	static void serialize(const std::variant<Ts...>& t, Serializer& ser)
+	{
+		if (t.valueless_by_exception())
+		{
+			throw std::invalid_argument(
+			    "Attempting to serialize valueless variant");
+		}
+
+		if (bits != 0)
+		{
+			ser.give(t.index(), bits);
+		}
+
+		std::visit([&ser](const auto& v) { ser.put(v); }, t);
+	}
+
+	static void deserialize(std::variant<Ts...>& t, Deserializer& des)
+	{
+		const size_t index = bits != 0 ? des.take<size_t>(bits) : 0;
+
+		if (index >= sizeof...(Ts))
+		{
+			throw std::out_of_range("Variant index out of range");
+		}
+
+		deserialize(t, index, des, make_sequence<sizeof...(Ts)>{});
+	}
+
+private:
+	static constexpr size_t bits = detail::tag_bits(sizeof...(Ts));
+
+	template <size_t... Is>
+	static void deserialize(std::variant<Ts...>& t,
+	                        size_t index,
+	                        Deserializer& des,
+	                        sequence<Is...>)
+	{
+		using alternative = void (*)(std::variant<Ts...>&, Deserializer&);
+
+		static constexpr alternative alternatives[] = {&emplace<Is>...};
+		alternatives[index](t, des);
+	}
+
+	template <size_t I>
+	static void emplace(std::variant<Ts...>& t, Deserializer& des)
+	{
+		if (t.index() != I)
+		{
+			t.template emplace<I>();
+		}
+
+		des.get(*std::get_if<I>(&t));
+	}
+};
+
+//////////////////
+//// Presence ////
+//////////////////
+
+template <typename T, typename = void>
+struct Presence
+{
+	static bool test(const T&) noexcept { return true; }
+
+	static void reset(T&) noexcept {}
+
+	static void serialize(const T& t, Serializer& ser) { ser.put(t); }
+
+	static void deserialize(T& t, Deserializer& des) { des.get(t); }
+};
+
+template <typename T>
+struct Presence<std::optional<T>>
+{
+	static bool test(const std::optional<T>& t) noexcept
+	{
+		return t.has_value();
+	}
+
+	static void reset(std::optional<T>& t) noexcept { t.reset(); }
+
+	static void serialize(const std::optional<T>& t, Serializer& ser)
+	{
+		ser.put(*t);
+	}
+
+	static void deserialize(std::optional<T>& t, Deserializer& des)
+	{
+		if (!t)
+		{
+			t.emplace();
+		}
+
+		des.get(*t);
+	}
+};
+
+////////////////
+//// Sparse ////
+////////////////
+
+template <typename T>
+class Sparse
+{
+public:
+	Sparse() = default;
+	Sparse(T value);
+
+	T& operator*() noexcept { return value; }
+
+	const T& operator*() const noexcept { return value; }
+
+	T* operator->() noexcept { return &value; }
+
+	const T* operator->() const noexcept { return &value; }
+
+private:
+	T value;
+};
+
+template <typename T>
+Sparse<T>::Sparse(T value)
+    : value(std::move(value))
+{}
+
+template <typename T>
+struct Policy<Sparse<T>, void, Priority::Primary>
+{
+	static void serialize(const Sparse<T>& t, Serializer& ser)
+	{
+		serialize(*t, ser, make_sequence<count>{});
+	}
+
+	static void deserialize(Sparse<T>& t, Deserializer& des)
+	{
+		auto members = member_tie(*t);
+		deserialize(members, des, make_sequence<count>{});
+	}
+
+private:
+	using tie    = decltype(member_tie(std::declval<T&>()));
+	using member = void (*)(tie&, Deserializer&);
+
+	static constexpr size_t count = member_count<T>::value;
+	static constexpr size_t width = bitsize<size_t>::value;
+	static constexpr size_t words = (count + width - 1) / width;
+
+	template <size_t... Is>
+	static void serialize(const T& t, Serializer& ser, sequence<Is...>)
+	{
+		using expand = int[];
+
+		auto members = member_tie(t);
+
+		std::array<size_t, words> bitmap{};
+		(void)expand{0,
+		             (bitmap[Is / width] |=
+		              size_t{test(std::get<Is>(members))} << (Is % width),
+		              0)...};
+
+		for (size_t i = 0; i < words; ++i)
+		{
+			ser.give(bitmap[i], i + 1 < words ? width : count - i * width);
+		}
+
+		(void)expand{0, (put(std::get<Is>(members), ser), 0)...};
+	}
+
+	template <size_t... Is>
+	static void deserialize(tie& members, Deserializer& des, sequence<Is...>)
+	{
+		static constexpr member present[] = {&get<Is>...};
+		static constexpr member absent[]  = {&reset<Is>...};
+
+		// The whole bitmap leads the members.
+		std::array<size_t, words> bitmap{};
+		for (size_t i = 0; i < words; ++i)
+		{
+			bitmap[i] = des.take<size_t>(i + 1 < words ? width
+			                                           : count - i * width);
+		}
+
+		for (size_t i = 0; i < words; ++i)
+		{
+			const size_t bits = i + 1 < words ? width : count - i * width;
+			const size_t mask = bits < width ? (size_t{1} << bits) - 1 : -1;
+
+			size_t set   = bitmap[i];
+			size_t unset = ~set & mask;
+
+			for (; set != 0; set &= set - 1)
+			{
+				present[i * width + detail::count_trailing_zeros(set)](members,
+				                                                       des);
+			}
+
+			for (; unset != 0; unset &= unset - 1)
+			{
+				absent[i * width + detail::count_trailing_zeros(unset)](members,
+				                                                        des);
+			}
+		}
+	}
+
+	template <typename U>
+	static bool test(const U& u) noexcept
+	{
+		return Presence<U>::test(u);
+	}
+
+	template <typename U>
+	static void put(const U& u, Serializer& ser)
+	{
+		if (Presence<U>::test(u))
+		{
+			Presence<U>::serialize(u, ser);
+		}
+	}
+
+	template <size_t I>
+	static void get(tie& members, Deserializer& des)
+	{
+		auto& u = std::get<I>(members);
+		Presence<typename std::decay<decltype(u)>::type>::deserialize(u, des);
+	}
+
+	template <size_t I>
+	static void reset(tie& members, Deserializer&)
+	{
+		auto& u = std::get<I>(members);
+		Presence<typename std::decay<decltype(u)>::type>::reset(u);
+	}
+};
+
+#endif
+
+namespace detail
+{
+	// Whole bytes of a value come out most significant first for MsbFirst and
+	// least significant first for LsbFirst, i.e. big and little endian.
+	inline ByteOrder host_byte_order() noexcept
+	{
+		const uint16_t v = 1;
+		uint8_t first;
+		std::memcpy(&first, &v, 1);
+
+		return first == 1 ? ByteOrder::LsbFirst : ByteOrder::MsbFirst;
+	}
+
+	inline void swap_bytes(uint8_t* p, size_t size, size_t count) noexcept
+	{
+		for (size_t i = 0; i < count; ++i, p += size)
+		{
+			for (size_t lo = 0, hi = size - 1; lo < hi; ++lo, --hi)
+			{
+				const uint8_t b = p[lo];
+				p[lo]           = p[hi];
+				p[hi]           = b;
+			}
+		}
+	}
+} // namespace detail
+
+/////////////////////////////
+//// Bytewise Serializer ////
+/////////////////////////////
+
+class BytewiseSerializer : public Serializer
+{
+public:
+	BytewiseSerializer(ByteOrder byteOrder) noexcept;
+
+	void flush();
+
+protected:
+	virtual void putByte(uint8_t byte) = 0;
+
+	virtual void putBytes(const uint8_t* bytes, size_t count);
+
+	void impl(size_t data, size_t bits) override;
+
+	void implMany(const void* data,
+	              size_t size,
+	              size_t count,
+	              size_t bits) override;
+
+	void implBytes(const uint8_t* bytes, size_t count) override;
+
+	bool implEncoded(const uint8_t* bytes,
+	                 size_t bits,
+	                 ByteOrder byteOrder) override;
+
+private:
+	ByteOrder byteOrder_;
+	uint8_t byte_    = 0;
+	uint8_t bitsSet_ = 0;
+};
+
+inline BytewiseSerializer::BytewiseSerializer(ByteOrder byteOrder) noexcept
+    : byteOrder_(byteOrder)
+{}
+
+inline void BytewiseSerializer::flush()
+{
+	if (bitsSet_ != 0)
+	{
+		// Pending bits sit one step past the last bit written; move them to
+		// where they would have been had the byte been completed.
+		if (byteOrder_ == ByteOrder::MsbFirst)
+		{
+			byte_ <<= bitsize<>::value - 1 - bitsSet_;
+		}
+		else
+		{
+			byte_ >>= bitsize<>::value - 1 - bitsSet_;
+		}
+
+		putByte(byte_);
+		byte_    = 0;
+		bitsSet_ = 0;
+	}
+}
+
+inline void BytewiseSerializer::putBytes(const uint8_t* bytes, size_t count)
+{
+	while (count--)
+	{
+		putByte(*(bytes++));
+	}
+}
+
+inline void BytewiseSerializer::implMany(const void* data,
+                                         size_t size,
+                                         size_t count,
+                                         size_t bits)
+{
+	// Values using their full width are already encoded, up to the order of
+	// their bytes.
+	if (bits != size * bitsize<>::value)
+	{
+		Serializer::implMany(data, size, count, bits);
+	}
+	else if (size == 1 || byteOrder_ == detail::host_byte_order())
+	{
+		implBytes(static_cast<const uint8_t*>(data), size * count);
+	}
+	else
+	{
+		const uint8_t* p = static_cast<const uint8_t*>(data);
+		uint8_t buffer[256];
+
+		while (count != 0)
+		{
+			const size_t n = count < sizeof(buffer) / size
+			                     ? count
+			                     : sizeof(buffer) / size;
+
+			std::memcpy(buffer, p, n * size);
+			detail::swap_bytes(buffer, size, n);
+			implBytes(buffer, n * size);
+
+			p     += n * size;
+			count -= n;
+		}
+	}
+}
+
+inline void BytewiseSerializer::implBytes(const uint8_t* bytes, size_t count)
+{
+	if (bitsSet_ == 0)
+	{
+		putBytes(bytes, count);
+		return;
+	}
+
+	// Each output byte is the pending bits followed by the leading bits of
+	// the next input byte, whose remaining bits are then pending.
+	const bool msb     = byteOrder_ == ByteOrder::MsbFirst;
+	const size_t shift = bitsize<>::value - 1 - bitsSet_;
+	const size_t rest  = bitsize<>::value - bitsSet_;
+
+	uint8_t pending =
+	    static_cast<uint8_t>(msb ? byte_ << shift : byte_ >> shift);
+	uint8_t buffer[256];
+
+	while (count != 0)
+	{
+		const size_t n = count < sizeof(buffer) ? count : sizeof(buffer);
+
+		for (size_t i = 0; i < n; ++i)
+		{
+			const uint8_t b = bytes[i];
+
+			if (msb)
+			{
+				buffer[i] = static_cast<uint8_t>(pending | (b >> bitsSet_));
+				pending   = static_cast<uint8_t>(b << rest);
+			}
+			else
+			{
+				buffer[i] = static_cast<uint8_t>(pending | (b << bitsSet_));
+				pending   = static_cast<uint8_t>(b >> rest);
+			}
+		}
+
+		putBytes(buffer, n);
+
+		bytes += n;
+		count -= n;
+	}
+
+	byte_ = static_cast<uint8_t>(msb ? pending >> shift : pending << shift);
+}
+
+inline bool BytewiseSerializer::implEncoded(const uint8_t* bytes,
+                                            size_t bits,
+                                            ByteOrder byteOrder)
+{
+	if (byteOrder != byteOrder_)
+	{
+		return false;
+	}
+
+	const size_t whole = bits / bitsize<>::value;
+	const size_t tail  = bits % bitsize<>::value;
+
+	implBytes(bytes, whole);
+
+	// A flushed partial byte keeps its bits where the next would have been
+	// read from first.
+	if (tail != 0)
+	{
+		const uint8_t last = bytes[whole];
+		impl(byteOrder_ == ByteOrder::MsbFirst
+		         ? last >> (bitsize<>::value - tail)
+		         : last & ((1u << tail) - 1),
+		     tail);
+	}
+
+	return true;
+}
+
+inline void BytewiseSerializer::impl(size_t data, size_t bits)
+{
+	if (byteOrder_ == ByteOrder::MsbFirst)
+	{
+		data <<= bitsize<size_t>::value - bits;
+	}
+
+	const uint8_t byteMask = byteOrder_ == ByteOrder::MsbFirst ? 0x01 : 0x80;
+	const size_t dataMask  = byteOrder_ == ByteOrder::MsbFirst
+	                             ? size_t{1} << (bitsize<size_t>::value - 1)
+	                             : 1;
+
+	while (bits--)
+	{
+		if (data & dataMask)
+		{
+			byte_ |= byteMask;
+		}
+
+		if (++bitsSet_ == bitsize<>::value)
+		{
+			putByte(byte_);
+			byte_    = 0;
+			bitsSet_ = 0;
+		}
+
+		if (byteOrder_ == ByteOrder::MsbFirst)
+		{
+			byte_ <<= 1;
+			data  <<= 1;
+		}
+		else
+		{
+			byte_ >>= 1;
+			data  >>= 1;
+		}
+	}
+}
+
+///////////////////////////////
+//// Bytewise Deserializer ////
+///////////////////////////////
+
+class BytewiseDeserializer : public Deserializer
+{
+public:
+	BytewiseDeserializer(ByteOrder byteOrder) noexcept;
+
+protected:
+	virtual uint8_t getByte() = 0;
+
+	virtual void getBytes(uint8_t* bytes, size_t count);
+
+	virtual void skipBytes(size_t count);
+
+	void impl(size_t& data, size_t bits, bool signExtend) override;
+
+	void implMany(void* data,
+	              size_t size,
+	              size_t count,
+	              size_t bits,
+	              bool signExtend) override;
+
+	void implBytes(uint8_t* bytes, size_t count) override;
+
+	void implSkip(size_t bits) override;
+
+private:
+	ByteOrder byteOrder_;
+	uint8_t byte_;
+	uint8_t bitsLeft_ = 0;
+};
+
+inline BytewiseDeserializer::BytewiseDeserializer(ByteOrder byteOrder) noexcept
+    : byteOrder_(byteOrder)
+{}
+
+inline void BytewiseDeserializer::getBytes(uint8_t* bytes, size_t count)
+{
+	while (count--)
+	{
+		*(bytes++) = getByte();
+	}
+}
+
+inline void BytewiseDeserializer::implMany(void* data,
+                                           size_t size,
+                                           size_t count,
+                                           size_t bits,
+                                           bool signExtend)
+{
+	if (bits != size * bitsize<>::value)
+	{
+		Deserializer::implMany(data, size, count, bits, signExtend);
+	}
+	else
+	{
+		implBytes(static_cast<uint8_t*>(data), size * count);
+
+		if (size != 1 && byteOrder_ != detail::host_byte_order())
+		{
+			detail::swap_bytes(static_cast<uint8_t*>(data), size, count);
+		}
+	}
+}
+
+inline void BytewiseDeserializer::implBytes(uint8_t* bytes, size_t count)
+{
+	getBytes(bytes, count);
+
+	if (bitsLeft_ == 0)
+	{
+		return;
+	}
+
+	// The bits left in the current byte lead each output byte, which is
+	// completed from the next input byte in place.
+	const bool msb    = byteOrder_ == ByteOrder::MsbFirst;
+	const size_t rest = bitsize<>::value - bitsLeft_;
+
+	uint8_t pending = static_cast<uint8_t>(msb ? byte_ << 1 : byte_ >> 1);
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		const uint8_t b = bytes[i];
+
+		if (msb)
+		{
+			bytes[i] = static_cast<uint8_t>(pending | (b >> bitsLeft_));
+			pending  = static_cast<uint8_t>(b << rest);
+		}
+		else
+		{
+			bytes[i] = static_cast<uint8_t>(pending | (b << bitsLeft_));
+			pending  = static_cast<uint8_t>(b >> rest);
+		}
+	}
+
+	byte_ = static_cast<uint8_t>(msb ? pending >> 1 : pending << 1);
+}
+
+inline void BytewiseDeserializer::skipBytes(size_t count)
+{
+	while (count--)
+	{
+		getByte();
+	}
+}
+
+inline void BytewiseDeserializer::implSkip(size_t bits)
+{
+	size_t v;
+
+	const size_t partial = bits < bitsLeft_ ? bits : bitsLeft_;
+	if (partial != 0)
+	{
+		impl(v, partial, false);
+		bits -= partial;
+	}
+
+	skipBytes(bits / bitsize<>::value);
+
+	if (bits % bitsize<>::value != 0)
+	{
+		impl(v, bits % bitsize<>::value, false);
+	}
+}
+
+inline void BytewiseDeserializer::impl(size_t& data,
+                                       size_t bits,
+                                       bool signExtend)
+{
+	size_t signMask = -1;
+
+	const uint8_t byteMask = byteOrder_ == ByteOrder::LsbFirst ? 0x01 : 0x80;
+	const size_t dataMask  = byteOrder_ == ByteOrder::LsbFirst
+	                             ? size_t{1} << (bitsize<size_t>::value - 1)
+	                             : 1;
+
+	for (size_t i = bits; i > 0; --i)
+	{
+		if (byteOrder_ == ByteOrder::LsbFirst)
+		{
+			byte_    >>= 1;
+			data     >>= 1;
+			signMask >>= 1;
+		}
+		else
+		{
+			byte_    <<= 1;
+			data     <<= 1;
+			signMask <<= 1;
+		}
+
+		if (bitsLeft_-- == 0)
+		{
+			byte_     = getByte();
+			bitsLeft_ = bitsize<>::value - 1;
+		}
+
+		if (byte_ & byteMask)
+		{
+			data |= dataMask;
+		}
+	}
+
+	if (byteOrder_ == ByteOrder::LsbFirst)
+	{
+		data     >>= bitsize<size_t>::value - bits;
+		signMask   = ~signMask;
+	}
+
+	if (signExtend)
+	{
+		data |= signMask;
+	}
+}
+
+////////////////////////////
+//// Dynamic Serializer ////
+////////////////////////////
+
+class DynamicSerializer : public BytewiseSerializer
+{
+public:
+	DynamicSerializer(ByteOrder byteOrder) noexcept;
+
+	const std::vector<uint8_t>& data() const noexcept { return bytes; }
+
+protected:
+	void putByte(uint8_t byte) override;
+
+	void putBytes(const uint8_t* pBytes, size_t count) override;
+
+private:
+	std::vector<uint8_t> bytes;
+};
+
+inline DynamicSerializer::DynamicSerializer(ByteOrder byteOrder) noexcept
+    : BytewiseSerializer(byteOrder)
+{}
+
+inline void DynamicSerializer::putByte(uint8_t byte)
+{
+	bytes.push_back(byte);
+}
+
+inline void DynamicSerializer::putBytes(const uint8_t* pBytes, size_t count)
+{
+	bytes.insert(bytes.end(), pBytes, pBytes + count);
+}
+
+//////////////////////////////
+//// Recording Serializer ////
+//////////////////////////////
+
+namespace detail
+{
+	// Holds what it is given until it is replayed into another serializer, so
+	// a value can be measured and then written without encoding it again. It
+	// counts from the position the replay will start at.
+	class RecordingSerializer : public Serializer
+	{
+	public:
+		explicit RecordingSerializer(size_t position) noexcept
+		    : Serializer(position),
+		      start_(position)
+		{}
+
+		void replay(Serializer& ser) const;
+
+	protected:
+		void impl(size_t data, size_t bits) override;
+
+		void implMany(const void* data,
+		              size_t size,
+		              size_t count,
+		              size_t bits) override;
+
+		void implBytes(const uint8_t* bytes, size_t count) override;
+
+	private:
+		// A value, or a run of count values of size bytes each kept in
+		// bytes_, with bits of zero marking a run given as bytes.
+		struct Entry
+		{
+			size_t data;
+			size_t bits;
+			size_t size;
+			size_t count;
+		};
+
+		size_t start_;
+		std::vector<Entry> entries_;
+		std::vector<uint8_t> bytes_;
+	};
+
+	inline void RecordingSerializer::impl(size_t data, size_t bits)
+	{
+		entries_.push_back({data, bits, 0, 0});
+	}
+
+	inline void RecordingSerializer::implMany(const void* data,
+	                                          size_t size,
+	                                          size_t count,
+	                                          size_t bits)
+	{
+		const uint8_t* p = static_cast<const uint8_t*>(data);
+
+		entries_.push_back({0, bits, size, count});
+		bytes_.insert(bytes_.end(), p, p + size * count);
+	}
+
+	inline void RecordingSerializer::implBytes(const uint8_t* bytes,
+	                                           size_t count)
+	{
+		entries_.push_back({0, 0, 1, count});
+		bytes_.insert(bytes_.end(), bytes, bytes + count);
+	}
+
+	inline void RecordingSerializer::replay(Serializer& ser) const
+	{
+		const uint8_t* p = bytes_.data();
+
+		for (const Entry& e : entries_)
+		{
+			if (e.size == 0)
+			{
+				ser.impl(e.data, e.bits);
+			}
+			else if (e.bits == 0)
+			{
+				ser.implBytes(p, e.count);
+			}
+			else
+			{
+				ser.implMany(p, e.size, e.count, e.bits);
+			}
+
+			p += e.size * e.count;
+		}
+
+		ser.position_  += tell() - start_;
+		ser.alignment_  = lcm(ser.alignment_, alignment());
+	}
+} // namespace detail
+
+/////////////////////////////
+//// Buffer Deserializer ////
+/////////////////////////////
+
+class BufferDeserializer : public BytewiseDeserializer
+{
+public:
+	BufferDeserializer(const void* pData,
+	                   size_t size,
+	                   ByteOrder byteOrder) noexcept;
+
+protected:
+	uint8_t getByte() override;
+
+	void getBytes(uint8_t* bytes, size_t count) override;
+
+	void skipBytes(size_t count) override;
+
+private:
+	const uint8_t* byte_;
+	size_t size_;
+};
+
+inline BufferDeserializer::BufferDeserializer(const void* pData,
+                                              size_t size,
+                                              ByteOrder byteOrder) noexcept
+    : BytewiseDeserializer(byteOrder),
+      byte_(static_cast<const uint8_t*>(pData)),
+      size_(size)
+{}
+
+inline uint8_t BufferDeserializer::getByte()
+{
+	if (size_ == 0)
+	{
+		throw std::out_of_range("Buffer deserializer out of range");
+	}
+	else
+	{
+		--size_;
+		return *(byte_++);
+	}
+}
+
+inline void BufferDeserializer::getBytes(uint8_t* bytes, size_t count)
+{
+	if (count > size_)
+	{
+		throw std::out_of_range("Buffer deserializer out of range");
+	}
+	else
+	{
+		std::memcpy(bytes, byte_, count);
+		size_ -= count;
+		byte_  += count;
+	}
+}
+
+inline void BufferDeserializer::skipBytes(size_t count)
+{
+	if (count > size_)
+	{
+		throw std::out_of_range("Buffer deserializer out of range");
+	}
+	else
+	{
+		size_ -= count;
+		byte_  += count;
+	}
+}
+
+////////////////
+//// Tagged ////
+////////////////
+
+namespace detail
+{
+	inline size_t varint_size(size_t v) noexcept
+	{
+		size_t n = 1;
+		for (; v >= 0x80; v >>= 7)
+		{
+			++n;
+		}
+
+		return n;
+	}
+
+	// Writes v in at least groups bytes, continuing with empty groups.
+	inline void put_varint(size_t v, Serializer& ser, size_t groups = 1)
+	{
+		for (size_t n = std::max(varint_size(v), groups); n > 1; --n, v >>= 7)
+		{
+			ser.give<size_t>((v & 0x7f) | 0x80, 8);
+		}
+
+		ser.give<size_t>(v, 8);
+	}
+
+	inline size_t take_varint(Deserializer& des)
+	{
+		size_t v = 0;
+
+		for (size_t shift = 0; shift < bitsize<size_t>::value; shift += 7)
+		{
+			const size_t group = des.take<size_t>(8);
+			const size_t width = bitsize<size_t>::value;
+
+			if (shift > width - 7 && (group & 0x7f) >> (width - shift) != 0)
+			{
+				throw std::out_of_range("Varint exceeds platform support");
+			}
+
+			v |= (group & 0x7f) << shift;
+
+			if ((group & 0x80) == 0)
+			{
+				return v;
+			}
+		}
+
+		throw std::out_of_range("Varint exceeds platform support");
+	}
+} // namespace detail
+
+template <typename T>
+class Tagged
+{
+public:
+	Tagged() = default;
+	Tagged(T value);
+
+	T& operator*() noexcept { return value; }
+
+	const T& operator*() const noexcept { return value; }
+
+	T* operator->() noexcept { return &value; }
+
+	const T* operator->() const noexcept { return &value; }
+
+private:
+	T value;
+};
+
+template <typename T>
+Tagged<T>::Tagged(T value)
+    : value(std::move(value))
+{}
+
+namespace detail
+{
+	// The length leads the member, so the member is recorded where it will
+	// land behind a length of so many bytes and replayed once the length is
+	// written. A longer length than that moves the member, which only needs
+	// it recorded again if the move breaks an alignment it relies on.
+	template <typename T>
+	void put_tagged(const T& t, size_t id, Serializer& ser)
+	{
+		put_varint(id, ser);
+
+		for (size_t groups = 1;;)
+		{
+			const size_t start = ser.tell() + groups * bitsize<>::value;
+
+			RecordingSerializer member(start);
+			member.put(t);
+
+			const size_t bits = member.tell() - start;
+			const size_t need = varint_size(bits);
+
+			if (need <= groups ||
+			    (need - groups) * bitsize<>::value % member.alignment() == 0)
+			{
+				put_varint(bits, ser, groups);
+				member.replay(ser);
+				return;
+			}
+
+			groups = need;
+		}
+	}
+
+	struct tagged_put_binder
+	{
+		template <typename T>
+		operator T()
+		{
+			base = (base + alignof(T) - 1) / alignof(T) * alignof(T);
+			put_tagged(*reinterpret_cast<const T*>(pData + base), ++id, ser);
+			base += sizeof(T);
+
+			return {};
+		}
+
+		const uint8_t* pData;
+		size_t& base;
+		size_t& id;
+		Serializer& ser;
+	};
+} // namespace detail
+
+template <typename T>
+struct Policy<Tagged<T>, void, Priority::Primary>
+{
+	static void serialize(const Tagged<T>& t, Serializer& ser)
+	{
+		serialize(*t, ser, make_sequence<member_count<T>::value>{});
+		detail::put_varint(0, ser);
+	}
+
+	static void deserialize(Tagged<T>& t, Deserializer& des)
+	{
+		deserialize(*t, des, make_sequence<member_count<T>::value>{});
+	}
+
+private:
+#if PYXI_CXX >= 17
+	template <size_t... Is>
+	static void serialize(const T& t, Serializer& ser, sequence<Is...> seq)
+	{
+		if constexpr (is_member_tieable<T>::value)
+		{
+			auto members = member_tie(t);
+			(detail::put_tagged(std::get<Is>(members), Is + 1, ser), ...);
+		}
+		else
+		{
+			bind(t, ser, seq);
+		}
+	}
+
+	template <size_t... Is>
+	static void deserialize(T& t, Deserializer& des, sequence<Is...> seq)
+	{
+		if constexpr (is_member_tieable<T>::value)
+		{
+			using tie    = decltype(member_tie(t));
+			using member = void (*)(tie&, Deserializer&);
+
+			static constexpr member members[] = {&get<tie, Is>...};
+
+			auto tied = member_tie(t);
+			read(des, [&](size_t i) { members[i](tied, des); });
+		}
+		else
+		{
+			lookup(t, des, seq);
+		}
+	}
+
+	template <typename Tie, size_t I>
+	static void get(Tie& members, Deserializer& des)
+	{
+		des.get(std::get<I>(members));
+	}
+#else
+	template <size_t... Is>
+	static void serialize(const T& t, Serializer& ser, sequence<Is...> seq)
+	{
+		bind(t, ser, seq);
+	}
+
+	template <size_t... Is>
+	static void deserialize(T& t, Deserializer& des, sequence<Is...> seq)
+	{
+		lookup(t, des, seq);
+	}
+#endif
+
+	template <size_t... Is>
+	static void bind(const T& t, Serializer& ser, sequence<Is...>)
+	{
+		size_t base = 0;
+		size_t id   = 0;
+		T{detail::tagged_put_binder{
+		    (static_cast<void>(Is), reinterpret_cast<const uint8_t*>(&t)),
+		    base,
+		    id,
+		    ser}...};
+	}
+
+	template <size_t... Is>
+	static void lookup(T& t, Deserializer& des, sequence<Is...>)
+	{
+		auto offsets       = member_offsets<T>::value();
+		auto deserializers = member_deserializers<T>::value();
+
+		read(des, [&](size_t i) { deserializers[i](&t, offsets[i], des); });
+	}
+
+	// Reads members by id until the terminating zero, handing known ids to
+	// get less one and skipping the rest.
+	template <typename F>
+	static void read(Deserializer& des, F get)
+	{
+		for (size_t id; (id = detail::take_varint(des)) != 0;)
+		{
+			const size_t bits = detail::take_varint(des);
+
+			if (id > member_count<T>::value)
+			{
+				des.skip(bits);
+				continue;
+			}
+
+			const size_t start = des.tell();
+			get(id - 1);
+
+			const size_t read = des.tell() - start;
+			if (read > bits)
+			{
+				throw std::out_of_range("Tagged member exceeds its length");
+			}
+
+			des.skip(bits - read);
+		}
+	}
+};
+
+////////////////////
+//// Preencoded ////
+////////////////////
+
+template <typename T, ByteOrder Order = ByteOrder::MsbFirst>
+class Preencoded
+{
+public:
+	Preencoded() = default;
+	Preencoded(T value);
+
+	Preencoded(const Preencoded& other);
+	Preencoded(Preencoded&& other);
+
+	Preencoded& operator=(Preencoded other);
+
+	// Mutable access may change the value, so it drops the cached encoding.
+	T& operator*() noexcept;
+
+	const T& operator*() const noexcept { return value; }
+
+	T* operator->() noexcept { return &**this; }
+
+	const T* operator->() const noexcept { return &value; }
+
+	const std::vector<uint8_t>& bytes() const;
+
+	size_t bits() const;
+
+	// The cached bits hold only at stream positions that are a multiple of
+	// this, when the value aligns itself.
+	size_t alignment() const;
+
+private:
+	void encode() const;
+
+	// Const access may come from several threads at once, so the first to
+	// find the cache empty fills it under the lock and publishes it through
+	// cached.
+	T value;
+	mutable std::mutex mutex;
+	mutable std::atomic<bool> cached{false};
+	mutable std::vector<uint8_t> encoded;
+	mutable size_t encodedBits      = 0;
+	mutable size_t encodedAlignment = 1;
+};
+
+template <typename T, ByteOrder Order>
+Preencoded<T, Order>::Preencoded(T value)
+    : value(std::move(value))
+{}
+
+template <typename T, ByteOrder Order>
+Preencoded<T, Order>::Preencoded(const Preencoded& other)
+    : value(other.value)
+{
+	if (other.cached.load(std::memory_order_acquire))
+	{
+		encoded          = other.encoded;
+		encodedBits      = other.encodedBits;
+		encodedAlignment = other.encodedAlignment;
+		cached.store(true, std::memory_order_relaxed);
+	}
+}
+
+template <typename T, ByteOrder Order>
+Preencoded<T, Order>::Preencoded(Preencoded&& other)
+    : value(std::move(other.value)),
+      cached(other.cached.load(std::memory_order_relaxed)),
+      encoded(std::move(other.encoded)),
+      encodedBits(other.encodedBits),
+      encodedAlignment(other.encodedAlignment)
+{}
+
+template <typename T, ByteOrder Order>
+Preencoded<T, Order>& Preencoded<T, Order>::operator=(Preencoded other)
+{
+	value            = std::move(other.value);
+	encoded          = std::move(other.encoded);
+	encodedBits      = other.encodedBits;
+	encodedAlignment = other.encodedAlignment;
+	cached.store(other.cached.load(std::memory_order_relaxed),
+	             std::memory_order_relaxed);
+
+	return *this;
+}
+
+template <typename T, ByteOrder Order>
+T& Preencoded<T, Order>::operator*() noexcept
+{
+	cached.store(false, std::memory_order_relaxed);
+	return value;
+}
+
+template <typename T, ByteOrder Order>
+const std::vector<uint8_t>& Preencoded<T, Order>::bytes() const
+{
+	encode();
+	return encoded;
+}
+
+template <typename T, ByteOrder Order>
+size_t Preencoded<T, Order>::bits() const
+{
+	encode();
+	return encodedBits;
+}
+
+template <typename T, ByteOrder Order>
+size_t Preencoded<T, Order>::alignment() const
+{
+	encode();
+	return encodedAlignment;
+}
+
+template <typename T, ByteOrder Order>
+void Preencoded<T, Order>::encode() const
+{
+	if (!cached.load(std::memory_order_acquire))
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		if (!cached.load(std::memory_order_relaxed))
+		{
+			DynamicSerializer ser(Order);
+			ser << value;
+			encodedBits      = ser.tell();
+			encodedAlignment = ser.alignment();
+			ser.flush();
+
+			encoded = ser.data();
+			cached.store(true, std::memory_order_release);
+		}
+	}
+}
+
+template <typename T, ByteOrder Order>
+struct Policy<Preencoded<T, Order>, void, Priority::Primary>
+{
+	static void serialize(const Preencoded<T, Order>& t, Serializer& ser)
+	{
+		// Streams of another byte order, or positions the cached bits do not
+		// hold at, encode the value afresh.
+		const size_t alignment = t.alignment();
+
+		if (ser.tell() % alignment == 0)
+		{
+			// Pads nothing, but carries over the alignment the bits rely on.
+			ser.align(alignment);
+
+			if (ser.write_encoded(t.bytes().data(), t.bits(), Order))
+			{
+				return;
+			}
+		}
+
+		ser.put(*t);
+	}
+
+	static void deserialize(Preencoded<T, Order>& t, Deserializer& des)
+	{
+		des.get(*t);
+	}
+};
+
+/////////////////
+//// Huffman ////
+/////////////////
+
+namespace detail
+{
+	constexpr size_t huffman_max_length = 16;
+
+	// Code lengths for the symbols with nonzero counts, limited to
+	// huffman_max_length by flattening the counts until the tree fits.
+	inline std::vector<uint8_t> huffman_lengths(std::vector<uint64_t> counts)
+	{
+		const size_t n = counts.size();
+		std::vector<uint8_t> lengths(n);
+
+		for (;;)
+		{
+			using Node = std::pair<uint64_t, size_t>;
+			std::priority_queue<Node, std::vector<Node>, std::greater<Node>>
+			    queue;
+			std::vector<size_t> parent(n, 0);
+
+			for (size_t i = 0; i < n; ++i)
+			{
+				queue.push(Node(counts[i], i));
+			}
+
+			while (queue.size() > 1)
+			{
+				const Node a = queue.top();
+				queue.pop();
+				const Node b = queue.top();
+				queue.pop();
+
+				parent[a.second] = parent[b.second] = parent.size();
+				parent.push_back(0);
+				queue.push(Node(a.first + b.first, parent.size() - 1));
+			}
+
+			// Parents always come after their children, so depths resolve
+			// from the root down.
+			std::vector<uint8_t> depth(parent.size(), 0);
+			for (size_t i = parent.size() - 1; i-- > 0;)
+			{
+				depth[i] = static_cast<uint8_t>(depth[parent[i]] + 1);
+			}
+
+			std::copy(depth.begin(), depth.begin() + n, lengths.begin());
+			if (*std::max_element(lengths.begin(), lengths.end()) <=
+			    huffman_max_length)
+			{
+				return lengths;
+			}
+
+			for (auto& count : counts)
+			{
+				count = count >> 1 | 1;
+			}
+		}
+	}
+
+	// Canonical codes: shorter first, then in symbol order.
+	inline std::vector<uint32_t> huffman_codes(
+	    const std::vector<uint8_t>& lengths)
+	{
+		std::vector<size_t> order(lengths.size());
+		for (size_t i = 0; i < order.size(); ++i)
+		{
+			order[i] = i;
+		}
+
+		std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+			return lengths[a] < lengths[b];
+		});
+
+		std::vector<uint32_t> codes(lengths.size());
+		uint64_t code = 0;
+		size_t length = 0;
+
+		for (size_t i : order)
+		{
+			if (lengths[i] == 0 || lengths[i] > huffman_max_length)
+			{
+				throw std::out_of_range("Huffman code lengths are invalid");
+			}
+
+			code <<= lengths[i] - length;
+			length = lengths[i];
+
+			if (code >> length != 0)
+			{
+				throw std::out_of_range("Huffman code lengths are invalid");
+			}
+
+			codes[i] = static_cast<uint32_t>(code++);
+		}
+
+		return codes;
+	}
+} // namespace detail
+
+// A collection of small integers, such as labels, written with a Huffman code
+// built for its contents, so that common values take fewer bits.
+template <typename T>
+class Huffman
+{
+public:
+	Huffman() = default;
+	Huffman(T value);
+
+	T& operator*() noexcept { return value; }
+
+	const T& operator*() const noexcept { return value; }
+
+	T* operator->() noexcept { return &value; }
+
+	const T* operator->() const noexcept { return &value; }
+
+private:
+	T value;
+};
+
+template <typename T>
+Huffman<T>::Huffman(T value)
+    : value(std::move(value))
+{}
+
+// The code table lists each symbol present with its code length, and the
+// coded bits follow, preceded by their count so the decoder can read them in
+// whole words and decode by table lookup.
+template <typename T>
+struct Policy<Huffman<T>, void, Priority::Primary>
+{
+	using V = typename T::value_type;
+	using S = typename std::make_unsigned<V>::type;
+
+	static_assert(is_resizable<T>::value && is_iterable<T>::value &&
+	                  std::is_integral<V>::value && bitsize<V>::value <= 16,
+	              "Huffman requires a resizable collection of small integers");
+
+	static void serialize(const Huffman<T>& t, Serializer& ser)
+	{
+		ser.put(t->size());
+
+		std::vector<uint64_t> counts(size_t{1} << bitsize<V>::value);
+		for (V v : *t)
+		{
+			++counts[static_cast<S>(v)];
+		}
+
+		std::vector<S> symbols;
+		std::vector<uint64_t> weights;
+		for (size_t i = 0; i < counts.size(); ++i)
+		{
+			if (counts[i] != 0)
+			{
+				symbols.push_back(static_cast<S>(i));
+				weights.push_back(counts[i]);
+			}
+		}
+
+		detail::put_varint(symbols.size(), ser);
+		if (symbols.size() <= 1)
+		{
+			for (S s : symbols)
+			{
+				ser.give(s);
+			}
+			return;
+		}
+
+		const auto lengths = detail::huffman_lengths(weights);
+		const auto codes   = detail::huffman_codes(lengths);
+
+		for (size_t i = 0; i < symbols.size(); ++i)
+		{
+			ser.give(symbols[i]);
+			ser.give<uint8_t>(lengths[i] - 1, 4);
+		}
+
+		std::vector<uint8_t> lengthOf(counts.size());
+		std::vector<uint32_t> codeOf(counts.size());
+		for (size_t i = 0; i < symbols.size(); ++i)
+		{
+			lengthOf[symbols[i]] = lengths[i];
+			codeOf[symbols[i]]   = codes[i];
+		}
+
+		// Gather the codes into whole words before handing them over.
+		std::vector<uint64_t> words;
+		uint64_t word = 0;
+		size_t used   = 0;
+
+		for (V v : *t)
+		{
+			const size_t length = lengthOf[static_cast<S>(v)];
+			const uint64_t code = codeOf[static_cast<S>(v)];
+
+			if (used + length < 64)
+			{
+				word = word << length | code;
+				used += length;
+			}
+			else
+			{
+				const size_t fit = 64 - used;
+				words.push_back(word << fit | code >> (length - fit));
+
+				used = length - fit;
+				word = code & ((uint64_t{1} << used) - 1);
+			}
+		}
+
+		detail::put_varint(words.size() * 64 + used, ser);
+		for (uint64_t w : words)
+		{
+			ser.give(w);
+		}
+
+		if (used != 0)
+		{
+			ser.give(word, used);
+		}
+	}
+
+	static void deserialize(Huffman<T>& t, Deserializer& des)
+	{
+		decltype(t->size()) size;
+		des.get(size);
+
+		const size_t n = detail::take_varint(des);
+		if (n > (size_t{1} << bitsize<V>::value) || (n == 0 && size != 0))
+		{
+			throw std::out_of_range("Huffman code table is invalid");
+		}
+
+		std::vector<S> symbols(n);
+		std::vector<uint8_t> lengths(n);
+
+		if (n == 1)
+		{
+			symbols[0] = des.take<S>();
+
+			t->resize(size);
+			std::fill(t->begin(), t->end(), static_cast<V>(symbols[0]));
+			return;
+		}
+
+		for (size_t i = 0; i < n; ++i)
+		{
+			symbols[i] = des.take<S>();
+			lengths[i] = static_cast<uint8_t>(des.take<uint8_t>(4) + 1);
+		}
+
+		const auto codes = n != 0 ? detail::huffman_codes(lengths)
+		                          : std::vector<uint32_t>();
+		const size_t width =
+		    n != 0 ? *std::max_element(lengths.begin(), lengths.end()) : 0;
+
+		// Every code, padded with whatever bits may follow it, indexes an
+		// entry holding its symbol and length.
+		std::vector<std::pair<S, uint8_t>> table(size_t{1} << width);
+		for (size_t i = 0; i < n; ++i)
+		{
+			const size_t shift = width - lengths[i];
+			const size_t first = static_cast<size_t>(codes[i]) << shift;
+
+			for (size_t j = 0; j < size_t{1} << shift; ++j)
+			{
+				table[first + j] = std::make_pair(symbols[i], lengths[i]);
+			}
+		}
+
+		const size_t bits = detail::take_varint(des);
+
+		std::vector<uint64_t> words;
+		for (size_t i = 0; i < bits / 64; ++i)
+		{
+			words.push_back(des.take<uint64_t>());
+		}
+		if (bits % 64 != 0)
+		{
+			words.push_back(des.take<uint64_t>(bits % 64) << (64 - bits % 64));
+		}
+		words.push_back(0);
+
+		t->resize(size);
+
+		size_t position = 0;
+		for (auto it = t->begin(); it != t->end(); ++it)
+		{
+			const size_t w = position / 64;
+			const size_t o = position % 64;
+
+			if (w >= words.size() - 1)
+			{
+				throw std::out_of_range("Huffman stream out of range");
+			}
+
+			uint64_t v = words[w] << o;
+			if (o != 0)
+			{
+				v |= words[w + 1] >> (64 - o);
+			}
+
+			const auto& entry = table[v >> (64 - width)];
+			if (entry.second == 0)
+			{
+				throw std::out_of_range("Huffman stream is invalid");
+			}
+
+			*it = static_cast<V>(entry.first);
+			position += entry.second;
+		}
+
+		if (position > bits)
+		{
+			throw std::out_of_range("Huffman stream out of range");
+		}
+	}
+};
+
+////////////////
+//// Schema ////
+////////////////
+
+namespace detail
+{
+	constexpr uint64_t schema_combine(uint64_t h, uint64_t v) noexcept
+	{
+		return (h ^ v) * 0x100000001b3;
+	}
+
+	constexpr uint64_t schema_seed(uint64_t kind) noexcept
+	{
+		return schema_combine(0xcbf29ce484222325, kind);
+	}
+
+	// Iterable types that are not stored as their elements, such as handles
+	// into other storage, specialize this to leave the collection schema and
+	// give their own at Priority::Primary.
+	template <typename T>
+	struct has_own_schema : public std::false_type
+	{};
+} // namespace detail
+
+template <typename T, typename = void, Priority P = Priority::First>
+struct Schema
+    : public Schema<
+          T,
+          void,
+          static_cast<Priority>(
+              static_cast<typename std::underlying_type<Priority>::type>(P) +
+              1)>
+{};
+
+template <typename T>
+struct Schema<T, void, Priority::Last>
+{
+	static_assert(sizeof(T) == 0, "No schema exists for this type");
+};
+
+template <typename T>
+constexpr uint64_t schema_hash() noexcept
+{
+	return Schema<T>::value();
+}
+
+template <typename T>
+struct Schema<T,
+              enable_if_t<has_serializer<T>::value || has_deserializer<T>::value>,
+              Priority::Primary>
+{
+	static constexpr uint64_t value() noexcept
+	{
+		return detail::schema_seed('x');
+	}
+};
+
+template <typename T>
+struct Schema<T, enable_if_t<std::is_integral<T>::value>, Priority::Primary>
+{
+	static constexpr uint64_t value() noexcept
+	{
+		// The signedness of char varies between platforms, so it gets a kind
+		// of its own rather than breaking every string across them.
+		return detail::schema_combine(
+		    detail::schema_seed(std::is_same<T, char>::value ? 'c'
+		                        : std::is_signed<T>::value   ? 'i'
+		                                                     : 'u'),
+		    bitsize<T>::value);
+	}
+};
+
+template <typename T>
+struct Schema<T, enable_if_t<std::is_enum<T>::value>, Priority::Primary>
+{
+	static constexpr uint64_t value() noexcept
+	{
+		return detail::schema_combine(
+		    detail::schema_seed('e'),
+		    schema_hash<typename std::underlying_type<T>::type>());
+	}
+};
+
+template <typename T>
+struct Schema<T,
+              void_t<typename floating_width_equivalent<T>::type>,
+              Priority::Primary>
+{
+	static constexpr uint64_t value() noexcept
+	{
+		return detail::schema_combine(detail::schema_seed('f'),
+		                              bitsize<T>::value);
+	}
+};
+
+template <typename T>
+struct Schema<T,
+              enable_if_t<is_iterable<T>::value && !is_associative<T>::value &&
+                          !detail::has_own_schema<T>::value>,
+              Priority::Primary>
+{
+	static constexpr uint64_t value() noexcept
+	{
+		return detail::schema_combine(
+		    detail::schema_seed(is_resizable<T>::value ? 'v' : 'a'),
+		    schema_hash<typename std::decay<decltype(
+		        *std::declval<T&>().begin())>::type>());
+	}
+};
+
+template <typename T>
+struct Schema<T,
+              enable_if_t<is_associative<T>::value && !is_mapping<T>::value>,
+              Priority::Primary>
+{
+	static constexpr uint64_t value() noexcept
+	{
+		return detail::schema_combine(detail::schema_seed('k'),
+		                              schema_hash<typename T::key_type>());
+	}
+};
+
+template <typename T>
+struct Schema<T,
+              enable_if_t<is_associative<T>::value && is_mapping<T>::value>,
+              Priority::Primary>
+{
+	static constexpr uint64_t value() noexcept
+	{
+		return detail::schema_combine(
+		    detail::schema_combine(detail::schema_seed('m'),
+		                           schema_hash<typename T::key_type>()),
+		    schema_hash<typename T::mapped_type>());
+	}
+};
+
+template <typename T, size_t Width>
+struct Schema<Bits<T, Width>, void, Priority::Primary>
+{
+	static constexpr uint64_t value() noexcept
+	{
+		return detail::schema_combine(
+		    detail::schema_combine(detail::schema_seed('b'), schema_hash<T>()),
+		    Width);
+	}
+};
+
+template <size_t Width>
+struct Schema<Spare<Width>, void, Priority::Primary>
+{
+	static constexpr uint64_t value() noexcept
+	{
+		return detail::schema_combine(detail::schema_seed('s'), Width);
+	}
+};
+
+template <size_t Width>
+struct Schema<Align<Width>, void, Priority::Primary>
+{
+	static constexpr uint64_t value() noexcept
+	{
+		return detail::schema_combine(detail::schema_seed('l'), Width);
+	}
+};
+
+template <typename T>
+struct Schema<Half<T>, void, Priority::Primary>
+{
+	static constexpr uint64_t value() noexcept
+	{
+		return detail::schema_seed('h');
+	}
+};
+
+namespace detail
+{
+	constexpr uint64_t schema_fold(uint64_t h) noexcept
+	{
+		return h;
+	}
+
+	template <typename... Ts>
+	constexpr uint64_t schema_fold(uint64_t h, uint64_t v, Ts... vs) noexcept
+	{
+		return schema_fold(schema_combine(h, v), vs...);
+	}
+} // namespace detail
+
+template <typename T0, typename T1>
+struct Schema<std::pair<T0, T1>, void, Priority::Primary>
+{
+	static constexpr uint64_t value() noexcept
+	{
+		return detail::schema_fold(
+		    detail::schema_seed('t'), schema_hash<T0>(), schema_hash<T1>());
+	}
+};
+
+template <typename... Ts>
+struct Schema<std::tuple<Ts...>, void, Priority::Primary>
+{
+	static constexpr uint64_t value() noexcept
+	{
+		return detail::schema_fold(detail::schema_seed('t'),
+		                           schema_hash<Ts>()...);
+	}
+};
+
+template <typename T, size_t Width, typename Min, typename Max>
+struct Schema<Quantized<T, Width, Min, Max>, void, Priority::Primary>
+{
+	static constexpr uint64_t value() noexcept
+	{
+		return detail::schema_fold(detail::schema_seed('q'),
+		                           Width,
+		                           static_cast<uint64_t>(Min::num),
+		                           static_cast<uint64_t>(Min::den),
+		                           static_cast<uint64_t>(Max::num),
+		                           static_cast<uint64_t>(Max::den));
+	}
+};
+
+template <typename T>
+struct Schema<Tagged<T>, void, Priority::Primary>
+{
+	// Tagged members may come and go without breaking readers, so they do
+	// not contribute to the schema.
+	static constexpr uint64_t value() noexcept
+	{
+		return detail::schema_seed('g');
+	}
+};
+
+template <typename T, ByteOrder Order>
+struct Schema<Preencoded<T, Order>, void, Priority::Primary>
+{
+	static constexpr uint64_t value() noexcept { return schema_hash<T>(); }
+};
+
+template <typename T>
+struct Schema<Natural<T>, void, Priority::Primary>
+{
+	static constexpr uint64_t value() noexcept
+	{
+		return detail::schema_combine(detail::schema_seed('w'),
+		                              schema_hash<T>());
+	}
+};
+
+template <typename T>
+struct Schema<Huffman<T>, void, Priority::Primary>
+{
+	static constexpr uint64_t value() noexcept
+	{
+		return detail::schema_combine(detail::schema_seed('d'),
+		                              schema_hash<T>());
+	}
+};
+
+template <typename T>
+struct Schema<TimeSeries<T>, void, Priority::Primary>
+{
+	static constexpr uint64_t value() noexcept
+	{
+		return detail::schema_combine(detail::schema_seed('z'),
+		                              schema_hash<T>());
+	}
+};
+
+#if PYXI_CXX >= 17
+
+template <typename T>
+struct Schema<std::optional<T>, void, Priority::Primary>
+{
+	static constexpr uint64_t value() noexcept
+	{
+		return detail::schema_combine(detail::schema_seed('o'),
+		                              schema_hash<T>());
+	}
+};
+
+template <typename... Ts>
+struct Schema<std::variant<Ts...>, void, Priority::Primary>
+{
+	static constexpr uint64_t value() noexcept
+	{
+		return detail::schema_fold(detail::schema_seed('n'),
+		                           schema_hash<Ts>()...);
+	}
+};
+
+template <typename T>
+struct Schema<Sparse<T>, void, Priority::Primary>
+{
+	static constexpr uint64_t value() noexcept
+	{
+		return detail::schema_combine(detail::schema_seed('p'),
+		                              schema_hash<T>());
+	}
+};
+
+#endif
+
+namespace detail
+{
+	struct atom_schema_binder
+	{
+		template <typename T>
+		operator T() noexcept
+		{
+			*hash = schema_combine(*hash, schema_hash<T>());
+			return {};
+		}
+
+		uint64_t* hash;
+	};
+
+	template <typename T, size_t... Is>
+	uint64_t member_schema_impl(sequence<Is...>) noexcept
+	{
+		uint64_t hash = schema_seed('r');
+		T{atom_schema_binder{(static_cast<void>(Is), &hash)}...};
+		return hash;
+	}
+
+#if PYXI_CXX >= 17
+	template <typename... Ts>
+	constexpr uint64_t member_schema_impl(std::tuple<Ts&...>*) noexcept
+	{
+		return schema_fold(schema_seed('r'),
+		                   schema_hash<std::remove_const_t<Ts>>()...);
+	}
+#endif
+} // namespace detail
+
+template <typename T>
+struct Schema<
+    T,
+    enable_if_t<std::is_class<T>::value && std::is_standard_layout<T>::value &&
+                member_count<T>::value != 0>,
+    Priority::Secondary>
+{
+#if PYXI_CXX >= 17
+	static constexpr uint64_t value() noexcept
+	{
+		if constexpr (is_member_tieable<T>::value)
+		{
+			return detail::member_schema_impl(
+			    static_cast<decltype(member_tie(std::declval<T&>()))*>(
+			        nullptr));
+		}
+		else
+		{
+			return cached();
+		}
+	}
+#else
+	static uint64_t value() noexcept { return cached(); }
+#endif
+
+private:
+	static uint64_t cached() noexcept
+	{
+		static const uint64_t hash = detail::member_schema_impl<T>(
+		    make_sequence<member_count<T>::value>{});
+		return hash;
+	}
+};
+
+template <typename T>
+void write_schema(Serializer& ser)
+{
+	const uint64_t hash = schema_hash<T>();
+
+	ser.give(static_cast<uint32_t>(hash >> 32));
+	ser.give(static_cast<uint32_t>(hash));
+}
+
+template <typename T>
+void check_schema(Deserializer& des)
+{
+	uint64_t hash = des.take<uint32_t>();
+	hash          = hash << 32 | des.take<uint32_t>();
+
+	if (hash != schema_hash<T>())
+	{
+		throw std::runtime_error("Schema of stream does not match type");
+	}
+}
+
+///////////////////
+//// serialize ////
+///////////////////
+
+template <typename T>
+std::vector<uint8_t> serialize(const T& t,
+                               ByteOrder byteOrder = ByteOrder::MsbFirst)
+{
+	DynamicSerializer ser(byteOrder);
+	ser << t;
+	ser.flush();
+	return ser.data();
+}
+
+/////////////////////
+//// deserialize ////
+/////////////////////
+
+template <typename T>
+void deserialize(T& t,
+                 const std::vector<uint8_t>& data,
+                 ByteOrder byteOrder = ByteOrder::MsbFirst)
+{
+	BufferDeserializer des(data.data(), data.size(), byteOrder);
+	des >> t;
+}
+
+template <typename T>
+void deserialize(T& t,
+                 const void* pData,
+                 size_t size,
+                 ByteOrder byteOrder = ByteOrder::MsbFirst)
+{
+	BufferDeserializer des(pData, size, byteOrder);
+	des >> t;
+}
+
+template <typename T>
+T deserialize(const std::vector<uint8_t>& data,
+              ByteOrder byteOrder = ByteOrder::MsbFirst)
+{
+	T t{};
+	deserialize(t, data.data(), data.size(), byteOrder);
+	return t;
+}
+
+template <typename T>
+T deserialize(const void* pData,
+              size_t size,
+              ByteOrder byteOrder = ByteOrder::MsbFirst)
+{
+	T t{};
+	deserialize(t, pData, size, byteOrder);
+	return t;
+}
+
+#if PYXI_CXX >= 17
+
+//////////////
+//// View ////
+//////////////
+
+namespace detail
+{
+	template <size_t... Ws>
+	struct fixed_sum
+	    : public std::integral_constant<size_t,
+	                                    ((Ws != 0) && ...) ? (Ws + ... + 0)
+	                                                       : 0>
+	{};
+
+	// The number of bits T always takes, or 0 when that depends on its value.
+	template <typename T, typename = void>
+	struct fixed_width : public std::integral_constant<size_t, 0>
+	{};
+
+	template <typename T>
+	struct fixed_width<
+	    T,
+	    enable_if_t<std::conjunction<std::is_arithmetic<T>,
+	                                 uses_policy<T, Priority::Primary>>::value>>
+	    : public std::integral_constant<size_t, bitsize<T>::value>
+	{};
+
+	template <typename T>
+	struct fixed_width<
+	    T,
+	    enable_if_t<std::conjunction<std::is_enum<T>,
+	                                 uses_policy<T, Priority::Primary>>::value>>
+	    : public std::integral_constant<
+	          size_t,
+	          bitsize<typename std::underlying_type<T>::type>::value>
+	{};
+
+	template <typename T, size_t Width>
+	struct fixed_width<
+	    Bits<T, Width>,
+	    enable_if_t<uses_policy<Bits<T, Width>, Priority::Primary>::value>>
+	    : public std::integral_constant<size_t, Width>
+	{};
+
+	template <size_t Width>
+	struct fixed_width<
+	    Spare<Width>,
+	    enable_if_t<uses_policy<Spare<Width>, Priority::Primary>::value>>
+	    : public std::integral_constant<size_t, Width>
+	{};
+
+	template <typename T>
+	struct fixed_width<
+	    Half<T>,
+	    enable_if_t<uses_policy<Half<T>, Priority::Primary>::value>>
+	    : public std::integral_constant<size_t, 16>
+	{};
+
+	template <typename T, size_t Width, typename Min, typename Max>
+	struct fixed_width<Quantized<T, Width, Min, Max>,
+	                   enable_if_t<uses_policy<Quantized<T, Width, Min, Max>,
+	                                           Priority::Primary>::value>>
+	    : public std::integral_constant<size_t, Width>
+	{};
+
+	template <typename T, size_t N>
+	struct fixed_width<
+	    std::array<T, N>,
+	    enable_if_t<uses_policy<std::array<T, N>, Priority::Primary>::value>>
+	    : public std::integral_constant<size_t, N * fixed_width<T>::value>
+	{};
+
+	template <typename T0, typename T1>
+	struct fixed_width<
+	    std::pair<T0, T1>,
+	    enable_if_t<uses_policy<std::pair<T0, T1>, Priority::Primary>::value>>
+	    : public fixed_sum<fixed_width<T0>::value, fixed_width<T1>::value>
+	{};
+
+	template <typename... Ts>
+	struct fixed_width<
+	    std::tuple<Ts...>,
+	    enable_if_t<uses_policy<std::tuple<Ts...>, Priority::Primary>::value>>
+	    : public fixed_sum<fixed_width<Ts>::value...>
+	{};
+
+	template <typename>
+	struct fixed_member_width;
+
+	template <typename... Ts>
+	struct fixed_member_width<std::tuple<Ts&...>>
+	    : public fixed_sum<fixed_width<std::decay_t<Ts>>::value...>
+	{};
+
+	// Collections are ruled out first, as counting the members of one with
+	// an initializer list constructor would never end.
+	template <typename T>
+	struct fixed_width<
+	    T,
+	    enable_if_t<std::conjunction<std::is_class<T>,
+	                                 std::negation<is_iterable<T>>,
+	                                 uses_policy<T, Priority::Secondary>,
+	                                 is_member_tieable<T>>::value>>
+	    : public fixed_member_width<decltype(member_tie(std::declval<T&>()))>
+	{};
+
+	// Moves past a T without decoding it where its size can be told from
+	// its type, or from the size of a collection of fixed-width elements.
+	template <typename T>
+	void view_skip(Deserializer& des)
+	{
+		if constexpr (fixed_width<T>::value != 0)
+		{
+			des.skip(fixed_width<T>::value);
+			return;
+		}
+		else if constexpr (is_resizable<T>::value && is_iterable<T>::value &&
+		                   !is_associative<T>::value &&
+		                   uses_policy<T, Priority::Primary>::value)
+		{
+			constexpr size_t width = fixed_width<typename T::value_type>::value;
+
+			if constexpr (width != 0)
+			{
+				decltype(std::declval<T&>().size()) size;
+				des.get(size);
+
+				if (size > static_cast<size_t>(-1) / width)
+				{
+					throw std::out_of_range("View out of range");
+				}
+
+				des.skip(size * width);
+				return;
+			}
+		}
+
+		T t{};
+		des.get(t);
+	}
+} // namespace detail
+
+// Reads single members of an encoded struct without decoding the rest.
+// Members are reached by skipping those before them, in constant time when
+// their width is fixed. Offsets found are cached, so a View is not safe to
+// use from several threads at once.
+template <typename T>
+class View
+{
+	static_assert(is_member_tieable<T>::value,
+	              "View requires a struct whose members can be tied");
+	static_assert(detail::uses_policy<T, Priority::Secondary>::value,
+	              "View requires a struct encoded member by member");
+
+	using Members = decltype(member_tie(std::declval<T&>()));
+
+public:
+	template <size_t I>
+	using member_type = std::decay_t<std::tuple_element_t<I, Members>>;
+
+	View(const void* pData,
+	     size_t size,
+	     ByteOrder byteOrder = ByteOrder::MsbFirst) noexcept;
+
+	explicit View(const std::vector<uint8_t>& data,
+	              ByteOrder byteOrder = ByteOrder::MsbFirst) noexcept;
+
+	template <size_t I>
+	member_type<I> get() const;
+
+	template <size_t I>
+	void get(member_type<I>& t) const;
+
+	T decode() const { return deserialize<T>(pData_, size_, byteOrder_); }
+
+	// Bit offset of member i from the start of the data.
+	size_t offset(size_t i) const;
+
+private:
+	template <size_t... Is>
+	static constexpr std::array<void (*)(Deserializer&), sizeof...(Is)>
+	skippers(sequence<Is...>) noexcept
+	{
+		return {&detail::view_skip<member_type<Is>>...};
+	}
+
+	const uint8_t* pData_;
+	size_t size_;
+	ByteOrder byteOrder_;
+	mutable std::vector<size_t> offsets_ = {0};
+};
+
+template <typename T>
+View<T>::View(const void* pData, size_t size, ByteOrder byteOrder) noexcept
+    : pData_(static_cast<const uint8_t*>(pData)),
+      size_(size),
+      byteOrder_(byteOrder)
+{}
+
+template <typename T>
+View<T>::View(const std::vector<uint8_t>& data, ByteOrder byteOrder) noexcept
+    : View(data.data(), data.size(), byteOrder)
+{}
+
+template <typename T>
+template <size_t I>
+typename View<T>::template member_type<I> View<T>::get() const
+{
+	member_type<I> t{};
+	get<I>(t);
+	return t;
+}
+
+template <typename T>
+template <size_t I>
+void View<T>::get(member_type<I>& t) const
+{
+	BufferDeserializer des(pData_, size_, byteOrder_);
+	des.skip(offset(I));
+	des.get(t);
+}
+
+template <typename T>
+size_t View<T>::offset(size_t i) const
+{
+	constexpr size_t count = std::tuple_size<Members>::value;
+	constexpr auto skip    = skippers(make_sequence<count>{});
+
+	if (i >= count)
+	{
+		throw std::out_of_range("View member out of range");
+	}
+
+	if (i >= offsets_.size())
+	{
+		BufferDeserializer des(pData_, size_, byteOrder_);
+		des.skip(offsets_.back());
+
+		while (offsets_.size() <= i)
+		{
+			skip[offsets_.size() - 1](des);
+			offsets_.push_back(des.tell());
+		}
+	}
+
+	return offsets_[i];
+}
+
+#endif
+
+///////////////
+//// Delta ////
+///////////////
+
+// A delta of a value is one bit telling whether it changed from the previous
+// value, followed when it did by the changes themselves: members and
+// elements are diffed recursively, anything else is written whole.
+template <typename T, typename = void, Priority P = Priority::First>
+struct Delta
+    : public Delta<
+          T,
+          void,
+          static_cast<Priority>(
+              static_cast<typename std::underlying_type<Priority>::type>(P) +
+              1)>
+{};
+
+template <typename T>
+void put_delta(const T& prev, const T& curr, Serializer& ser)
+{
+	if (Delta<T>::equal(prev, curr))
+	{
+		ser.give(false, 1);
+	}
+	else
+	{
+		ser.give(true, 1);
+		Delta<T>::serialize(prev, curr, ser);
+	}
+}
+
+template <typename T>
+void get_delta(T& t, Deserializer& des)
+{
+	if (des.take<bool>(1))
+	{
+		Delta<T>::deserialize(t, des);
+	}
+}
+
+namespace detail
+{
+	template <typename T>
+	bool delta_equal(const T& a, const T& b)
+	{
+		return Delta<T>::equal(a, b);
+	}
+} // namespace detail
+
+template <typename T>
+struct Delta<T, void, Priority::Last>
+{
+	static bool equal(const T& a, const T& b)
+	{
+		return equal(a, b, is_equality_comparable<T>{});
+	}
+
+	static void serialize(const T&, const T& curr, Serializer& ser)
+	{
+		ser.put(curr);
+	}
+
+	static void deserialize(T& t, Deserializer& des) { des.get(t); }
+
+private:
+	static bool equal(const T& a, const T& b, std::true_type)
+	{
+		return a == b;
+	}
+
+	// Without an equality operator, values are equal when they encode to
+	// the same bits.
+	static bool equal(const T& a, const T& b, std::false_type)
+	{
+		DynamicSerializer x(ByteOrder::MsbFirst);
+		DynamicSerializer y(ByteOrder::MsbFirst);
+		x << a;
+		y << b;
+
+		if (x.tell() != y.tell())
+		{
+			return false;
+		}
+
+		x.flush();
+		y.flush();
+		return x.data() == y.data();
+	}
+};
+
+// Types with their own hooks and pyxi's wrappers are written whole; the
+// wrappers would otherwise pass for structs with one member.
+template <typename T>
+struct Delta<T,
+             enable_if_t<has_serializer<T>::value || has_deserializer<T>::value>,
+             Priority::Primary> : public Delta<T, void, Priority::Last>
+{};
+
+template <typename T, size_t Width>
+struct Delta<Bits<T, Width>, void, Priority::Primary>
+    : public Delta<Bits<T, Width>, void, Priority::Last>
+{};
+
+template <typename T>
+struct Delta<Half<T>, void, Priority::Primary>
+    : public Delta<Half<T>, void, Priority::Last>
+{};
+
+template <typename T, size_t Width, typename Min, typename Max>
+struct Delta<Quantized<T, Width, Min, Max>, void, Priority::Primary>
+    : public Delta<Quantized<T, Width, Min, Max>, void, Priority::Last>
+{};
+
+template <typename T>
+struct Delta<Tagged<T>, void, Priority::Primary>
+    : public Delta<Tagged<T>, void, Priority::Last>
+{};
+
+template <typename T>
+struct Delta<Natural<T>, void, Priority::Primary>
+    : public Delta<Natural<T>, void, Priority::Last>
+{};
+
+template <typename T>
+struct Delta<Huffman<T>, void, Priority::Primary>
+    : public Delta<Huffman<T>, void, Priority::Last>
+{};
+
+template <typename T>
+struct Delta<TimeSeries<T>, void, Priority::Primary>
+    : public Delta<TimeSeries<T>, void, Priority::Last>
+{};
+
+template <typename T, ByteOrder Order>
+struct Delta<Preencoded<T, Order>, void, Priority::Primary>
+    : public Delta<Preencoded<T, Order>, void, Priority::Last>
+{};
+
+#if PYXI_CXX >= 17
+template <typename T>
+struct Delta<std::optional<T>, void, Priority::Primary>
+    : public Delta<std::optional<T>, void, Priority::Last>
+{};
+
+template <typename... Ts>
+struct Delta<std::variant<Ts...>, void, Priority::Primary>
+    : public Delta<std::variant<Ts...>, void, Priority::Last>
+{};
+
+template <typename T>
+struct Delta<Sparse<T>, void, Priority::Primary>
+    : public Delta<Sparse<T>, void, Priority::Last>
+{};
+#endif
+
+template <typename T>
+struct Delta<T,
+             enable_if_t<is_resizable<T>::value && is_iterable<T>::value>,
+             Priority::Primary>
+{
+	static bool equal(const T& a, const T& b)
+	{
+		if (a.size() != b.size())
+		{
+			return false;
+		}
+
+		for (auto i = a.begin(), j = b.begin(); i != a.end(); ++i, ++j)
+		{
+			if (!detail::delta_equal(*i, *j))
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	// Elements both values have are diffed, those past the end of the
+	// previous value are written whole.
+	static void serialize(const T& prev, const T& curr, Serializer& ser)
+	{
+		ser.put(curr.size());
+
+		auto p = prev.begin();
+		for (auto c = curr.begin(); c != curr.end(); ++c)
+		{
+			if (p != prev.end())
+			{
+				put_delta(*p, *c, ser);
+				++p;
+			}
+			else
+			{
+				ser.put(*c);
+			}
+		}
+	}
+
+	static void deserialize(T& t, Deserializer& des)
+	{
+		decltype(t.size()) size;
+		des.get(size);
+
+		const auto kept = t.size() < size ? t.size() : size;
+		t.resize(size);
+
+		auto it = t.begin();
+		for (decltype(size) i = 0; i < kept; ++i, ++it)
+		{
+			get_delta(*it, des);
+		}
+
+		for (; it != t.end(); ++it)
+		{
+			des.get(*it);
+		}
+	}
+};
+
+template <typename T>
+struct Delta<T,
+             enable_if_t<!is_resizable<T>::value && !is_associative<T>::value &&
+                         is_iterable<T>::value>,
+             Priority::Primary>
 {
-public:
-	BufferDeserializer(const void* pData,
-	                   size_t size,
-	                   ByteOrder byteOrder) noexcept;
+	static bool equal(const T& a, const T& b)
+	{
+		for (auto i = a.begin(), j = b.begin(); i != a.end(); ++i, ++j)
+		{
+			if (!detail::delta_equal(*i, *j))
+			{
+				return false;
+			}
+		}
 
-protected:
-	uint8_t getByte() override;
+		return true;
+	}
 
-private:
-	const uint8_t* byte_;
-	size_t size_;
+	static void serialize(const T& prev, const T& curr, Serializer& ser)
+	{
+		auto p = prev.begin();
+		for (auto c = curr.begin(); c != curr.end(); ++c, ++p)
+		{
+			put_delta(*p, *c, ser);
+		}
+	}
+
+	static void deserialize(T& t, Deserializer& des)
+	{
+		for (auto it = t.begin(); it != t.end(); ++it)
+		{
+			get_delta(*it, des);
+		}
+	}
 };
 
-inline BufferDeserializer::BufferDeserializer(const void* pData,
-                                              size_t size,
-                                              ByteOrder byteOrder) noexcept
-    : BytewiseDeserializer(byteOrder),
-      byte_(static_cast<const uint8_t*>(pData)),
-      size_(size)
-{}
+namespace detail
+{
+	struct atom_delta_equal_binder
+	{
+		template <typename T>
+		operator T()
+		{
+			base  = (base + alignof(T) - 1) / alignof(T) * alignof(T);
+			equal = equal &&
+			        delta_equal(*reinterpret_cast<const T*>(pA + base),
+			                    *reinterpret_cast<const T*>(pB + base));
+			base += sizeof(T);
 
-inline uint8_t BufferDeserializer::getByte()
+			return {};
+		}
+
+		const uint8_t* pA;
+		const uint8_t* pB;
+		size_t& base;
+		bool& equal;
+	};
+
+	struct atom_delta_put_binder
+	{
+		template <typename T>
+		operator T()
+		{
+			base = (base + alignof(T) - 1) / alignof(T) * alignof(T);
+			put_delta(*reinterpret_cast<const T*>(pPrev + base),
+			          *reinterpret_cast<const T*>(pCurr + base),
+			          ser);
+			base += sizeof(T);
+
+			return {};
+		}
+
+		const uint8_t* pPrev;
+		const uint8_t* pCurr;
+		size_t& base;
+		Serializer& ser;
+	};
+
+	struct atom_delta_get_binder
+	{
+		template <typename T>
+		operator T()
+		{
+			base = (base + alignof(T) - 1) / alignof(T) * alignof(T);
+			get_delta(*reinterpret_cast<T*>(pData + base), des);
+			base += sizeof(T);
+
+			return {};
+		}
+
+		uint8_t* pData;
+		size_t& base;
+		Deserializer& des;
+	};
+} // namespace detail
+
+template <typename T>
+struct Delta<
+    T,
+    enable_if_t<std::is_class<T>::value && std::is_standard_layout<T>::value &&
+                member_count<T>::value != 0>,
+    Priority::Secondary>
 {
-	if (size_ == 0)
+	static bool equal(const T& a, const T& b)
 	{
-		throw std::out_of_range("Buffer deserializer out of range");
+		return equal(a, b, make_sequence<member_count<T>::value>{});
 	}
-	else
+
+	static void serialize(const T& prev, const T& curr, Serializer& ser)
 	{
-		--size_;
-		return *(byte_++);
+		serialize(prev, curr, ser, make_sequence<member_count<T>::value>{});
 	}
-}
 
-///////////////////
-//// serialize ////
-///////////////////
+	static void deserialize(T& t, Deserializer& des)
+	{
+		deserialize(t, des, make_sequence<member_count<T>::value>{});
+	}
+
+private:
+#if PYXI_CXX >= 17
+	template <size_t... Is>
+	static bool equal(const T& a, const T& b, sequence<Is...> seq)
+	{
+		if constexpr (is_member_tieable<T>::value)
+		{
+			auto x = member_tie(a);
+			auto y = member_tie(b);
+			return (detail::delta_equal(std::get<Is>(x), std::get<Is>(y)) &&
+			        ...);
+		}
+		else
+		{
+			return bind(a, b, seq);
+		}
+	}
+
+	template <size_t... Is>
+	static void serialize(const T& prev,
+	                      const T& curr,
+	                      Serializer& ser,
+	                      sequence<Is...> seq)
+	{
+		if constexpr (is_member_tieable<T>::value)
+		{
+			auto p = member_tie(prev);
+			auto c = member_tie(curr);
+			(put_delta(std::get<Is>(p), std::get<Is>(c), ser), ...);
+		}
+		else
+		{
+			bind(prev, curr, ser, seq);
+		}
+	}
+
+	template <size_t... Is>
+	static void deserialize(T& t, Deserializer& des, sequence<Is...> seq)
+	{
+		if constexpr (is_member_tieable<T>::value)
+		{
+			auto members = member_tie(t);
+			(get_delta(std::get<Is>(members), des), ...);
+		}
+		else
+		{
+			bind(t, des, seq);
+		}
+	}
+#else
+	template <size_t... Is>
+	static bool equal(const T& a, const T& b, sequence<Is...> seq)
+	{
+		return bind(a, b, seq);
+	}
+
+	template <size_t... Is>
+	static void serialize(const T& prev,
+	                      const T& curr,
+	                      Serializer& ser,
+	                      sequence<Is...> seq)
+	{
+		bind(prev, curr, ser, seq);
+	}
+
+	template <size_t... Is>
+	static void deserialize(T& t, Deserializer& des, sequence<Is...> seq)
+	{
+		bind(t, des, seq);
+	}
+#endif
+
+	template <size_t... Is>
+	static bool bind(const T& a, const T& b, sequence<Is...>)
+	{
+		size_t base = 0;
+		bool equal  = true;
+		T{detail::atom_delta_equal_binder{
+		    (static_cast<void>(Is), reinterpret_cast<const uint8_t*>(&a)),
+		    reinterpret_cast<const uint8_t*>(&b),
+		    base,
+		    equal}...};
+		return equal;
+	}
+
+	template <size_t... Is>
+	static void bind(const T& prev,
+	                 const T& curr,
+	                 Serializer& ser,
+	                 sequence<Is...>)
+	{
+		size_t base = 0;
+		T{detail::atom_delta_put_binder{
+		    (static_cast<void>(Is), reinterpret_cast<const uint8_t*>(&prev)),
+		    reinterpret_cast<const uint8_t*>(&curr),
+		    base,
+		    ser}...};
+	}
+
+	template <size_t... Is>
+	static void bind(T& t, Deserializer& des, sequence<Is...>)
+	{
+		size_t base = 0;
+		T{detail::atom_delta_get_binder{
+		    (static_cast<void>(Is), reinterpret_cast<uint8_t*>(&t)),
+		    base,
+		    des}...};
+	}
+};
 
 template <typename T>
-std::vector<uint8_t> serialize(const T& t,
-                               ByteOrder byteOrder = ByteOrder::MsbFirst)
+std::vector<uint8_t> serialize_delta(const T& prev,
+                                     const T& curr,
+                                     ByteOrder byteOrder = ByteOrder::MsbFirst)
 {
 	DynamicSerializer ser(byteOrder);
-	ser << t;
+	put_delta(prev, curr, ser);
 	ser.flush();
 	return ser.data();
 }
 
-/////////////////////
-//// deserialize ////
-/////////////////////
-
-template <typename T>
-void deserialize(T& t,
-                 const std::vector<uint8_t>& data,
-                 ByteOrder byteOrder = ByteOrder::MsbFirst)
-{
-	BufferDeserializer des(data.data(), data.size(), byteOrder);
-	des >> t;
-}
-
 template <typename T>
-void deserialize(T& t,
+void apply_delta(T& t,
                  const void* pData,
                  size_t size,
                  ByteOrder byteOrder = ByteOrder::MsbFirst)
 {
 	BufferDeserializer des(pData, size, byteOrder);
-	des >> t;
+	get_delta(t, des);
 }
 
 template <typename T>
-T deserialize(const std::vector<uint8_t>& data,
-              ByteOrder byteOrder = ByteOrder::MsbFirst)
+void apply_delta(T& t,
+                 const std::vector<uint8_t>& data,
+                 ByteOrder byteOrder = ByteOrder::MsbFirst)
 {
-	T t{};
-	deserialize(t, data.data(), data.size(), byteOrder);
-	return t;
+	apply_delta(t, data.data(), data.size(), byteOrder);
 }
 
-template <typename T>
-T deserialize(const void* pData,
-              size_t size,
-              ByteOrder byteOrder = ByteOrder::MsbFirst)
+///////////////////
+//// XOR Patch ////
+///////////////////
+
+namespace detail
 {
-	T t{};
-	deserialize(t, pData, size, byteOrder);
-	return t;
-}
+	// Returns the first index from i where a and b differ if equal is true,
+	// or where they match if it is false, or n if there is none.
+	inline size_t xor_run_end(const uint8_t* a,
+	                          const uint8_t* b,
+	                          size_t i,
+	                          size_t n,
+	                          bool equal) noexcept
+	{
+#if defined(__SSE2__)
+		for (; i + 16 <= n; i += 16)
+		{
+			const __m128i x =
+			    _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+			const __m128i y =
+			    _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+
+			size_t mask =
+			    static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(x, y)));
+			if (equal)
+			{
+				mask = ~mask & 0xffff;
+			}
+
+			if (mask != 0)
+			{
+				return i + count_trailing_zeros(mask);
+			}
+		}
+#endif
+		while (i < n && (a[i] == b[i]) == equal)
+		{
+			++i;
+		}
 
-///////////////
-//// align ////
-///////////////
+		return i;
+	}
 
-inline void align(std::vector<uint8_t>& data, size_t alignment)
+	// Bytes past the common length count as differing. Returns the first
+	// index from i where the frames differ, or size if there is none.
+	inline size_t xor_next_diff(const uint8_t* a,
+	                            const uint8_t* b,
+	                            size_t i,
+	                            size_t common,
+	                            size_t size) noexcept
+	{
+		return i < common ? xor_run_end(a, b, i, common, true)
+		                  : (i < size ? i : size);
+	}
+
+	inline size_t xor_next_same(const uint8_t* a,
+	                            const uint8_t* b,
+	                            size_t i,
+	                            size_t common,
+	                            size_t size) noexcept
+	{
+		const size_t same = i < common ? xor_run_end(a, b, i, common, false)
+		                               : common;
+		return same < common ? same : size;
+	}
+} // namespace detail
+
+// Encodes curr as the runs of bytes where it differs from prev, each stored
+// as the XOR of both. Bytes past the end of prev are taken to differ.
+inline std::vector<uint8_t> xor_diff(const std::vector<uint8_t>& prev,
+                                     const std::vector<uint8_t>& curr)
 {
-	if (data.size() % alignment != 0)
+	const uint8_t* p    = prev.data();
+	const uint8_t* c    = curr.data();
+	const size_t size   = curr.size();
+	const size_t common = prev.size() < size ? prev.size() : size;
+
+	DynamicSerializer ser(ByteOrder::MsbFirst);
+	detail::put_varint(size, ser);
+
+	size_t last  = 0;
+	size_t start = detail::xor_next_diff(p, c, 0, common, size);
+
+	while (start < size)
 	{
-		for (size_t i = 0; i < alignment - (data.size() % alignment); ++i)
+		size_t end  = detail::xor_next_same(p, c, start, common, size);
+		size_t next = detail::xor_next_diff(p, c, end, common, size);
+
+		// A run costs two varints, so gaps of up to two matching bytes are
+		// cheaper to carry inside it.
+		while (next < size && next - end <= 2)
+		{
+			end  = detail::xor_next_same(p, c, next, common, size);
+			next = detail::xor_next_diff(p, c, end, common, size);
+		}
+
+		detail::put_varint(start - last, ser);
+		detail::put_varint(end - start, ser);
+
+		uint8_t buffer[256];
+		for (size_t i = start; i < end;)
 		{
-			data.push_back(0);
+			const size_t n =
+			    end - i < sizeof(buffer) ? end - i : sizeof(buffer);
+
+			for (size_t j = 0; j < n; ++j, ++i)
+			{
+				buffer[j] = i < common ? c[i] ^ p[i] : c[i];
+			}
+
+			ser.write_bytes(buffer, n);
 		}
+
+		last  = end;
+		start = next;
 	}
+
+	ser.flush();
+	return ser.data();
 }
 
-inline std::vector<uint8_t> align(std::vector<uint8_t>&& data, size_t alignment)
+// Turns the frame a patch was made against into the frame it was made from.
+inline void xor_patch(std::vector<uint8_t>& frame,
+                      const std::vector<uint8_t>& patch)
 {
-	if (data.size() % alignment != 0)
+	BufferDeserializer des(patch.data(), patch.size(), ByteOrder::MsbFirst);
+
+	frame.resize(detail::take_varint(des));
+
+	size_t i = 0;
+	while (des.tell() < patch.size() * bitsize<>::value)
 	{
-		for (size_t i = 0; i < alignment - (data.size() % alignment); ++i)
+		const size_t skip = detail::take_varint(des);
+		if (skip > frame.size() - i)
 		{
-			data.push_back(0);
+			throw std::out_of_range("XOR patch exceeds its frame");
+		}
+		i += skip;
+
+		const size_t n = detail::take_varint(des);
+		if (n > frame.size() - i)
+		{
+			throw std::out_of_range("XOR patch exceeds its frame");
+		}
+
+		uint8_t buffer[256];
+		for (const size_t end = i + n; i < end;)
+		{
+			const size_t m =
+			    end - i < sizeof(buffer) ? end - i : sizeof(buffer);
+			des.read_bytes(buffer, m);
+
+			for (size_t j = 0; j < m; ++j, ++i)
+			{
+				frame[i] ^= buffer[j];
+			}
 		}
 	}
+}
+
+///////////////
+//// align ////
+///////////////
+
+inline void align(std::vector<uint8_t>& data, size_t alignment)
+{
+	data.resize((data.size() + alignment - 1) / alignment * alignment);
+}
 
-	return data;
+inline std::vector<uint8_t> align(std::vector<uint8_t>&& data, size_t alignment)
+{
+	align(data, alignment);
+	return std::move(data);
 }
 
 } // namespace pyxi
 
+/////////////////////////
+//// Extern Policies ////
+/////////////////////////
+
+// Declares the policy of a type without defining it, so translation units
+// calling it link against the single definition emitted by
+// PYXI_INSTANTIATE_POLICY instead of instantiating it themselves. Both must be
+// used at global scope, and the declaration must precede any use of the type
+// with pyxi.
+#define PYXI_EXTERN_POLICY(...)                                       \
+	namespace pyxi                                                    \
+	{                                                                 \
+	template <>                                                       \
+	struct Policy<__VA_ARGS__, void, Priority::First>                 \
+	{                                                                 \
+		static void serialize(const __VA_ARGS__& t, Serializer& ser); \
+                                                                      \
+		static void deserialize(__VA_ARGS__& t, Deserializer& des);   \
+	};                                                                \
+	}
+
+#define PYXI_INSTANTIATE_POLICY(...)                                         \
+	void pyxi::Policy<__VA_ARGS__, void, pyxi::Priority::First>::serialize(  \
+	    const __VA_ARGS__& t, pyxi::Serializer& ser)                         \
+	{                                                                        \
+		pyxi::Policy<__VA_ARGS__, void, pyxi::Priority::Primary>::serialize( \
+		    t, ser);                                                         \
+	}                                                                        \
+                                                                             \
+	void pyxi::Policy<__VA_ARGS__, void, pyxi::Priority::First>::            \
+	    deserialize(__VA_ARGS__& t, pyxi::Deserializer& des)                 \
+	{                                                                        \
+		pyxi::Policy<__VA_ARGS__, void, pyxi::Priority::Primary>::           \
+		    deserialize(t, des);                                             \
+	}
+
 #endif
@@ -0,0 +1,1638 @@
+// MIT License
+//
+// Copyright (c) 2024 James Geiss
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef PYXI_RECORD_HPP
+#define PYXI_RECORD_HPP
+
+#include "pyxi.hpp"
+
+#if PYXI_CXX < 17
+#error "pyxi_record.hpp requires C++17"
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define PYXI_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#define PYXI_MMAP 0
+#endif
+
+// A record file is, with every integer written most significant byte first:
+//
+//   header   "PYXR", u16 version, u16 reserved, u64 schema hash
+//   records  u32 length, u32 CRC-32 of the payload, payload
+//   syncs    u32 0xffffffff, u64 sync word, u64 records before it
+//   index    u32 0xfffffffe, u64 count, u64 offset of each record
+//   trailer  u64 offset of the index, u32 CRC-32 of the index, "PYXE"
+//
+// Syncs are written between records every so many bytes, so a reader that
+// finds a damaged record can resume at the next one.
+
+namespace pyxi
+{
+
+///////////////
+//// crc32 ////
+///////////////
+
+namespace detail
+{
+	constexpr std::array<uint32_t, 256> make_crc32_table() noexcept
+	{
+		std::array<uint32_t, 256> table{};
+
+		for (uint32_t i = 0; i < 256; ++i)
+		{
+			uint32_t c = i;
+			for (int k = 0; k < 8; ++k)
+			{
+				c = c & 1 ? 0xedb88320 ^ (c >> 1) : c >> 1;
+			}
+
+			table[i] = c;
+		}
+
+		return table;
+	}
+
+	inline constexpr std::array<uint32_t, 256> crc32_table =
+	    make_crc32_table();
+} // namespace detail
+
+inline uint32_t crc32(const void* data, size_t size, uint32_t crc = 0) noexcept
+{
+	const uint8_t* p = static_cast<const uint8_t*>(data);
+
+	crc = ~crc;
+	while (size--)
+	{
+		crc = detail::crc32_table[(crc ^ *(p++)) & 0xff] ^ (crc >> 8);
+	}
+
+	return ~crc;
+}
+
+///////////////////////////
+//// Stream Serializer ////
+///////////////////////////
+
+class StreamSerializer : public BytewiseSerializer
+{
+public:
+	StreamSerializer(std::ostream& stream, ByteOrder byteOrder) noexcept;
+
+protected:
+	void putByte(uint8_t byte) override;
+
+	void putBytes(const uint8_t* pBytes, size_t count) override;
+
+private:
+	std::ostream& stream_;
+};
+
+inline StreamSerializer::StreamSerializer(std::ostream& stream,
+                                          ByteOrder byteOrder) noexcept
+    : BytewiseSerializer(byteOrder),
+      stream_(stream)
+{}
+
+inline void StreamSerializer::putByte(uint8_t byte)
+{
+	putBytes(&byte, 1);
+}
+
+inline void StreamSerializer::putBytes(const uint8_t* pBytes, size_t count)
+{
+	if (!stream_.write(reinterpret_cast<const char*>(pBytes),
+	                   static_cast<std::streamsize>(count)))
+	{
+		throw std::runtime_error("Stream serializer failed to write");
+	}
+}
+
+/////////////////////////////
+//// Stream Deserializer ////
+/////////////////////////////
+
+class StreamDeserializer : public BytewiseDeserializer
+{
+public:
+	StreamDeserializer(std::istream& stream, ByteOrder byteOrder) noexcept;
+
+protected:
+	uint8_t getByte() override;
+
+	void getBytes(uint8_t* bytes, size_t count) override;
+
+	void skipBytes(size_t count) override;
+
+private:
+	std::istream& stream_;
+};
+
+inline StreamDeserializer::StreamDeserializer(std::istream& stream,
+                                              ByteOrder byteOrder) noexcept
+    : BytewiseDeserializer(byteOrder),
+      stream_(stream)
+{}
+
+inline uint8_t StreamDeserializer::getByte()
+{
+	uint8_t byte;
+	getBytes(&byte, 1);
+	return byte;
+}
+
+inline void StreamDeserializer::getBytes(uint8_t* bytes, size_t count)
+{
+	if (!stream_.read(reinterpret_cast<char*>(bytes),
+	                  static_cast<std::streamsize>(count)))
+	{
+		throw std::out_of_range("Stream deserializer out of range");
+	}
+}
+
+inline void StreamDeserializer::skipBytes(size_t count)
+{
+	if (!stream_.seekg(static_cast<std::streamoff>(count), std::ios::cur))
+	{
+		throw std::out_of_range("Stream deserializer out of range");
+	}
+}
+
+/////////////////////
+//// Record File ////
+/////////////////////
+
+namespace detail
+{
+	constexpr uint32_t record_magic   = 0x50595852; // "PYXR"
+	constexpr uint32_t record_end     = 0x50595845; // "PYXE"
+	constexpr uint16_t record_version = 1;
+
+	constexpr uint32_t record_sync_tag  = 0xffffffff;
+	constexpr uint32_t record_index_tag = 0xfffffffe;
+	constexpr uint64_t record_sync_word = 0x9d2c5680a1b7e3f4;
+
+	constexpr uint64_t record_header_size  = 16;
+	constexpr uint64_t record_frame_size   = 8;
+	constexpr uint64_t record_sync_size    = 20;
+	constexpr uint64_t record_trailer_size = 16;
+
+	// Lengths from here up are tags rather than records.
+	constexpr uint32_t record_max_size = 0xfffffff0;
+
+	inline void put_record_header(Serializer& ser, uint64_t schema)
+	{
+		ser.give(record_magic);
+		ser.give(record_version);
+		ser.give(uint16_t{0});
+		ser.give(schema);
+	}
+
+	// Checks the header and returns the schema hash it names.
+	inline uint64_t get_record_header(Deserializer& des)
+	{
+		if (des.take<uint32_t>() != record_magic)
+		{
+			throw std::runtime_error("Not a record file");
+		}
+		if (des.take<uint16_t>() != record_version)
+		{
+			throw std::runtime_error("Unsupported record file version");
+		}
+
+		des.take<uint16_t>();
+		return des.take<uint64_t>();
+	}
+
+	inline void put_record_sync(Serializer& ser, uint64_t count)
+	{
+		ser.give(record_sync_tag);
+		ser.give(record_sync_word);
+		ser.give(count);
+	}
+
+	// Writes the index and trailer, given where the index starts.
+	inline void put_record_index(Serializer& ser,
+	                             const std::vector<uint64_t>& offsets,
+	                             uint64_t indexOffset)
+	{
+		DynamicSerializer index(ByteOrder::MsbFirst);
+		index.give(record_index_tag);
+		index.give(static_cast<uint64_t>(offsets.size()));
+		index.give_many(offsets.data(), offsets.size());
+
+		ser.write_bytes(index.data().data(), index.data().size());
+
+		ser.give(indexOffset);
+		ser.give(crc32(index.data().data(), index.data().size()));
+		ser.give(record_end);
+	}
+} // namespace detail
+
+///////////////////////
+//// Record Reader ////
+///////////////////////
+
+class RecordReader
+{
+public:
+	explicit RecordReader(const std::string& path);
+
+	uint64_t schema() const noexcept { return schema_; }
+
+	size_t size() const noexcept { return offsets_.size(); }
+
+	const std::vector<uint64_t>& offsets() const noexcept { return offsets_; }
+
+	// Offset just past the last intact record, where appending resumes.
+	uint64_t end() const noexcept { return end_; }
+
+	// Whether the index was rebuilt by scanning the records, because the
+	// file was not closed properly or its footer is damaged.
+	bool recovered() const noexcept { return recovered_; }
+
+	std::vector<uint8_t> read_record(size_t i);
+
+	// Decodes record i as T, which must have the schema of the file.
+	template <typename T>
+	void read(size_t i, T& t);
+
+	template <typename T>
+	T read(size_t i);
+
+private:
+	bool load_index();
+
+	void scan();
+
+	bool check_record(uint64_t offset, uint64_t& next);
+
+	bool find_sync(uint64_t& offset);
+
+	StreamDeserializer at(uint64_t offset);
+
+	std::ifstream stream_;
+	uint64_t fileSize_;
+	uint64_t schema_;
+	std::vector<uint64_t> offsets_;
+	uint64_t end_   = detail::record_header_size;
+	bool recovered_ = false;
+};
+
+inline RecordReader::RecordReader(const std::string& path)
+    : stream_(path, std::ios::binary),
+      fileSize_(std::filesystem::file_size(path))
+{
+	if (!stream_)
+	{
+		throw std::runtime_error("Failed to open record file");
+	}
+
+	if (fileSize_ < detail::record_header_size)
+	{
+		throw std::runtime_error("Record file has no header");
+	}
+
+	auto des = at(0);
+	schema_  = detail::get_record_header(des);
+
+	if (!load_index())
+	{
+		recovered_ = true;
+		scan();
+	}
+}
+
+inline std::vector<uint8_t> RecordReader::read_record(size_t i)
+{
+	auto des = at(offsets_.at(i));
+
+	const uint32_t size = des.take<uint32_t>();
+	const uint32_t crc  = des.take<uint32_t>();
+
+	std::vector<uint8_t> payload(size);
+	des.read_bytes(payload.data(), size);
+
+	if (crc32(payload.data(), size) != crc)
+	{
+		throw std::runtime_error("Record checksum mismatch");
+	}
+
+	return payload;
+}
+
+template <typename T>
+void RecordReader::read(size_t i, T& t)
+{
+	if (schema_ != schema_hash<T>())
+	{
+		throw std::runtime_error("Schema of record file does not match type");
+	}
+
+	deserialize(t, read_record(i));
+}
+
+template <typename T>
+T RecordReader::read(size_t i)
+{
+	T t{};
+	read(i, t);
+	return t;
+}
+
+inline bool RecordReader::load_index()
+{
+	if (fileSize_ < detail::record_header_size + detail::record_trailer_size)
+	{
+		return false;
+	}
+
+	const uint64_t trailer = fileSize_ - detail::record_trailer_size;
+
+	auto des             = at(trailer);
+	const uint64_t index = des.take<uint64_t>();
+	const uint32_t crc   = des.take<uint32_t>();
+
+	if (des.take<uint32_t>() != detail::record_end ||
+	    index < detail::record_header_size || index + 12 > trailer)
+	{
+		return false;
+	}
+
+	std::vector<uint8_t> bytes(trailer - index);
+	at(index).read_bytes(bytes.data(), bytes.size());
+
+	if (crc32(bytes.data(), bytes.size()) != crc)
+	{
+		return false;
+	}
+
+	BufferDeserializer entries(bytes.data(), bytes.size(), ByteOrder::MsbFirst);
+	const uint32_t tag   = entries.take<uint32_t>();
+	const uint64_t count = entries.take<uint64_t>();
+
+	if (tag != detail::record_index_tag || count != (bytes.size() - 12) / 8)
+	{
+		return false;
+	}
+
+	offsets_.resize(count);
+	entries.take_many(offsets_.data(), count);
+	end_ = index;
+
+	return true;
+}
+
+inline void RecordReader::scan()
+{
+	uint64_t offset = detail::record_header_size;
+
+	while (offset + 4 <= fileSize_)
+	{
+		uint64_t next;
+
+		if (!check_record(offset, next))
+		{
+			// Skip the damage up to the next sync.
+			if (!find_sync(++offset))
+			{
+				break;
+			}
+		}
+		else if (next == offset)
+		{
+			break;
+		}
+		else
+		{
+			offset = end_ = next;
+		}
+	}
+}
+
+// Tells whether an intact record or sync starts at offset, and where the
+// next one would start. An index ends the records, and leaves next at offset.
+inline bool RecordReader::check_record(uint64_t offset, uint64_t& next)
+{
+	auto des           = at(offset);
+	const uint32_t tag = des.take<uint32_t>();
+
+	if (tag == detail::record_index_tag)
+	{
+		next = offset;
+		return true;
+	}
+	else if (tag == detail::record_sync_tag)
+	{
+		if (offset + detail::record_sync_size > fileSize_ ||
+		    des.take<uint64_t>() != detail::record_sync_word)
+		{
+			return false;
+		}
+
+		next = offset + detail::record_sync_size;
+		return true;
+	}
+	else if (tag >= detail::record_max_size ||
+	         offset + detail::record_frame_size + tag > fileSize_)
+	{
+		return false;
+	}
+
+	const uint32_t crc = des.take<uint32_t>();
+
+	std::vector<uint8_t> payload(tag);
+	des.read_bytes(payload.data(), tag);
+
+	if (crc32(payload.data(), tag) != crc)
+	{
+		return false;
+	}
+
+	offsets_.push_back(offset);
+	next = offset + detail::record_frame_size + tag;
+	return true;
+}
+
+// Moves offset to the next sync at or after it.
+inline bool RecordReader::find_sync(uint64_t& offset)
+{
+	uint8_t pattern[12];
+	for (size_t i = 0; i < 4; ++i)
+	{
+		pattern[i] = static_cast<uint8_t>(detail::record_sync_tag);
+	}
+	for (size_t i = 0; i < 8; ++i)
+	{
+		pattern[4 + i] =
+		    static_cast<uint8_t>(detail::record_sync_word >> (56 - 8 * i));
+	}
+
+	std::vector<uint8_t> chunk(1 << 16);
+
+	while (offset + sizeof(pattern) <= fileSize_)
+	{
+		const uint64_t n = std::min<uint64_t>(chunk.size(), fileSize_ - offset);
+		at(offset).read_bytes(chunk.data(), n);
+
+		auto found = std::search(
+		    chunk.begin(), chunk.begin() + n, pattern, pattern + sizeof(pattern));
+		if (found != chunk.begin() + n)
+		{
+			offset += found - chunk.begin();
+			return true;
+		}
+
+		// Keep enough of the chunk to find a pattern straddling the next.
+		offset += n - (sizeof(pattern) - 1);
+	}
+
+	return false;
+}
+
+inline StreamDeserializer RecordReader::at(uint64_t offset)
+{
+	stream_.clear();
+	stream_.seekg(static_cast<std::streamoff>(offset));
+	return StreamDeserializer(stream_, ByteOrder::MsbFirst);
+}
+
+///////////////////////
+//// Record Writer ////
+///////////////////////
+
+class RecordWriter
+{
+public:
+	enum class Mode
+	{
+		Truncate,
+		Append
+	};
+
+	RecordWriter(const std::string& path,
+	             uint64_t schema,
+	             Mode mode           = Mode::Truncate,
+	             size_t syncInterval = 1 << 16);
+
+	RecordWriter(const RecordWriter&)            = delete;
+	RecordWriter& operator=(const RecordWriter&) = delete;
+
+	~RecordWriter();
+
+	uint64_t schema() const noexcept { return schema_; }
+
+	// Appends t, which must have the schema the file was opened with.
+	template <typename T>
+	void write(const T& t);
+
+	void write_record(const void* data, size_t size);
+
+	size_t size() const noexcept { return offsets_.size(); }
+
+	// Writes the index and footer. Records written before a crash remain
+	// readable without them.
+	void close();
+
+private:
+	uint64_t position() const noexcept
+	{
+		return base_ + ser_.tell() / bitsize<>::value;
+	}
+
+	std::string path_;
+	std::fstream stream_;
+	StreamSerializer ser_;
+	uint64_t schema_;
+	std::vector<uint64_t> offsets_;
+	uint64_t base_     = 0;
+	uint64_t lastSync_ = 0;
+	size_t syncInterval_;
+	bool open_ = true;
+};
+
+inline RecordWriter::RecordWriter(const std::string& path,
+                                  uint64_t schema,
+                                  Mode mode,
+                                  size_t syncInterval)
+    : path_(path),
+      ser_(stream_, ByteOrder::MsbFirst),
+      schema_(schema),
+      syncInterval_(syncInterval)
+{
+	if (mode == Mode::Append && std::filesystem::exists(path) &&
+	    std::filesystem::file_size(path) != 0)
+	{
+		RecordReader reader(path);
+		if (reader.schema() != schema)
+		{
+			throw std::runtime_error("Schema of record file does not match");
+		}
+
+		offsets_ = reader.offsets();
+		base_    = reader.end();
+
+		stream_.open(path, std::ios::binary | std::ios::in | std::ios::out);
+		stream_.seekp(static_cast<std::streamoff>(base_));
+	}
+	else
+	{
+		stream_.open(path,
+		             std::ios::binary | std::ios::out | std::ios::trunc);
+	}
+
+	if (!stream_)
+	{
+		throw std::runtime_error("Failed to open record file");
+	}
+
+	if (base_ == 0)
+	{
+		detail::put_record_header(ser_, schema);
+	}
+
+	lastSync_ = position();
+}
+
+inline RecordWriter::~RecordWriter()
+{
+	try
+	{
+		close();
+	}
+	catch (...)
+	{}
+}
+
+template <typename T>
+void RecordWriter::write(const T& t)
+{
+	if (schema_ != schema_hash<T>())
+	{
+		throw std::runtime_error("Schema of record file does not match type");
+	}
+
+	const auto bytes = serialize(t);
+	write_record(bytes.data(), bytes.size());
+}
+
+inline void RecordWriter::write_record(const void* data, size_t size)
+{
+	if (size >= detail::record_max_size)
+	{
+		throw std::invalid_argument("Record exceeds maximum size");
+	}
+
+	if (position() - lastSync_ >= syncInterval_)
+	{
+		detail::put_record_sync(ser_, offsets_.size());
+		lastSync_ = position();
+	}
+
+	offsets_.push_back(position());
+
+	ser_.give(static_cast<uint32_t>(size));
+	ser_.give(crc32(data, size));
+	ser_.write_bytes(data, size);
+}
+
+inline void RecordWriter::close()
+{
+	if (!open_)
+	{
+		return;
+	}
+
+	open_ = false;
+
+	detail::put_record_index(ser_, offsets_, position());
+
+	const uint64_t end = position();
+
+	stream_.close();
+	if (!stream_)
+	{
+		throw std::runtime_error("Failed to write record file");
+	}
+
+	// Appending may leave the old footer, or a torn record, past the end.
+	std::filesystem::resize_file(path_, end);
+}
+
+/////////////////////
+//// Mapped File ////
+/////////////////////
+
+namespace detail
+{
+	// A whole file, mapped where the platform supports it and read into
+	// memory otherwise. A private mapping may be written to without the
+	// changes reaching the file, until seal makes it read-only.
+	class MappedFile
+	{
+	public:
+		explicit MappedFile(const std::string& path, bool isPrivate = false);
+
+		MappedFile(const MappedFile&)            = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		~MappedFile();
+
+		const uint8_t* data() const noexcept { return data_; }
+
+		uint8_t* data() noexcept { return data_; }
+
+		uint64_t size() const noexcept { return size_; }
+
+		void seal();
+
+	private:
+		uint8_t* data_ = nullptr;
+		uint64_t size_ = 0;
+#if !PYXI_MMAP
+		std::vector<uint8_t> buffer_;
+#endif
+	};
+
+#if PYXI_MMAP
+	inline MappedFile::MappedFile(const std::string& path, bool isPrivate)
+	{
+		const int fd = ::open(path.c_str(), O_RDONLY);
+		if (fd < 0)
+		{
+			throw std::runtime_error("Failed to open file");
+		}
+
+		struct stat info;
+		if (::fstat(fd, &info) != 0)
+		{
+			::close(fd);
+			throw std::runtime_error("Failed to open file");
+		}
+
+		size_ = static_cast<uint64_t>(info.st_size);
+		if (size_ != 0)
+		{
+			const int protection =
+			    isPrivate ? PROT_READ | PROT_WRITE : PROT_READ;
+
+			void* p = ::mmap(nullptr, size_, protection, MAP_PRIVATE, fd, 0);
+			if (p == MAP_FAILED)
+			{
+				::close(fd);
+				throw std::runtime_error("Failed to map file");
+			}
+
+			if (!isPrivate)
+			{
+				::madvise(p, size_, MADV_SEQUENTIAL);
+			}
+			data_ = static_cast<uint8_t*>(p);
+		}
+
+		::close(fd);
+	}
+
+	inline MappedFile::~MappedFile()
+	{
+		if (data_)
+		{
+			::munmap(data_, size_);
+		}
+	}
+
+	inline void MappedFile::seal()
+	{
+		if (data_ && ::mprotect(data_, size_, PROT_READ) != 0)
+		{
+			throw std::runtime_error("Failed to protect mapped file");
+		}
+	}
+#else
+	inline MappedFile::MappedFile(const std::string& path, bool)
+	    : size_(std::filesystem::file_size(path)),
+	      buffer_(size_)
+	{
+		std::ifstream stream(path, std::ios::binary);
+		if (!stream.read(reinterpret_cast<char*>(buffer_.data()),
+		                 static_cast<std::streamsize>(size_)))
+		{
+			throw std::runtime_error("Failed to read file");
+		}
+
+		data_ = buffer_.data();
+	}
+
+	inline MappedFile::~MappedFile() {}
+
+	inline void MappedFile::seal() {}
+#endif
+} // namespace detail
+
+//////////////////////
+//// Record Merge ////
+//////////////////////
+
+namespace detail
+{
+	using RecordConverter =
+	    std::function<std::vector<uint8_t>(const uint8_t*, size_t)>;
+
+	struct MergeSource
+	{
+		std::unique_ptr<MappedFile> file;
+		std::vector<uint8_t> converted;
+		const uint8_t* base = nullptr;
+
+		// Offset from base and payload size of each record to copy.
+		std::vector<std::pair<uint64_t, uint32_t>> records;
+
+		uint64_t start = 0;
+		size_t first   = 0;
+	};
+
+	// Calls task(i) for every i below count, spread over threads threads.
+	// The first exception thrown stops the rest and is rethrown.
+	template <typename F>
+	void parallel_for(size_t count, unsigned threads, F task)
+	{
+		std::atomic<size_t> next{0};
+		std::exception_ptr error;
+		std::mutex mutex;
+
+		auto work = [&]() {
+			for (size_t i; (i = next++) < count;)
+			{
+				try
+				{
+					task(i);
+				}
+				catch (...)
+				{
+					std::lock_guard<std::mutex> lock(mutex);
+					if (!error)
+					{
+						error = std::current_exception();
+					}
+					next = count;
+				}
+			}
+		};
+
+		std::vector<std::thread> pool;
+		for (unsigned t = 1; t < threads && t < count; ++t)
+		{
+			pool.emplace_back(work);
+		}
+
+		work();
+
+		for (auto& thread : pool)
+		{
+			thread.join();
+		}
+
+		if (error)
+		{
+			std::rethrow_exception(error);
+		}
+	}
+
+	// Finds the intact records of path and, when its schema differs and
+	// convert is set, re-encodes them.
+	inline void load_merge_source(MergeSource& source,
+	                              const std::string& path,
+	                              uint64_t schema,
+	                              const RecordConverter& convert)
+	{
+		RecordReader reader(path);
+
+		if (reader.schema() != schema && !convert)
+		{
+			throw std::runtime_error("Schema of record file does not match");
+		}
+
+		source.file = std::make_unique<MappedFile>(path);
+		source.base = source.file->data();
+
+		const uint64_t fileSize = source.file->size();
+
+		DynamicSerializer frames(ByteOrder::MsbFirst);
+
+		for (uint64_t offset : reader.offsets())
+		{
+			if (offset + record_frame_size > fileSize)
+			{
+				continue;
+			}
+
+			BufferDeserializer des(
+			    source.base + offset, record_frame_size, ByteOrder::MsbFirst);
+			const uint32_t size = des.take<uint32_t>();
+			const uint32_t crc  = des.take<uint32_t>();
+
+			const uint8_t* payload = source.base + offset + record_frame_size;
+			if (offset + record_frame_size + size > fileSize ||
+			    crc32(payload, size) != crc)
+			{
+				continue;
+			}
+
+			if (reader.schema() == schema)
+			{
+				source.records.emplace_back(offset, size);
+				continue;
+			}
+
+			const auto bytes = convert(payload, size);
+			if (bytes.size() >= record_max_size)
+			{
+				throw std::invalid_argument("Record exceeds maximum size");
+			}
+
+			source.records.emplace_back(frames.tell() / bitsize<>::value,
+			                            static_cast<uint32_t>(bytes.size()));
+
+			frames.give(static_cast<uint32_t>(bytes.size()));
+			frames.give(crc32(bytes.data(), bytes.size()));
+			frames.write_bytes(bytes.data(), bytes.size());
+		}
+
+		if (reader.schema() != schema)
+		{
+			frames.flush();
+			source.converted = frames.data();
+			source.base      = source.converted.data();
+			source.file.reset();
+		}
+	}
+
+	// Copies the records of source into place, coalescing those that were
+	// already adjacent into a single write.
+	inline void write_merge_source(const MergeSource& source,
+	                               const std::vector<uint64_t>& offsets,
+	                               const std::string& output)
+	{
+		std::fstream stream(output,
+		                    std::ios::binary | std::ios::in | std::ios::out);
+		stream.seekp(static_cast<std::streamoff>(source.start));
+
+		StreamSerializer ser(stream, ByteOrder::MsbFirst);
+
+		uint64_t position = source.start;
+		uint64_t run      = 0;
+		uint64_t runEnd   = 0;
+
+		for (size_t j = 0; j < source.records.size(); ++j)
+		{
+			const uint64_t offset = source.records[j].first;
+			const uint64_t target = offsets[source.first + j];
+			const uint64_t length = record_frame_size + source.records[j].second;
+
+			if (target != position || offset != runEnd)
+			{
+				ser.write_bytes(source.base + run, runEnd - run);
+				run = runEnd = offset;
+			}
+
+			if (target != position)
+			{
+				put_record_sync(ser, source.first + j);
+				position = target;
+			}
+
+			runEnd += length;
+			position += length;
+		}
+
+		ser.write_bytes(source.base + run, runEnd - run);
+
+		stream.close();
+		if (!stream)
+		{
+			throw std::runtime_error("Failed to write record file");
+		}
+	}
+
+	inline size_t merge_records(const std::vector<std::string>& inputs,
+	                            const std::string& output,
+	                            uint64_t schema,
+	                            const RecordConverter& convert,
+	                            unsigned threads,
+	                            size_t syncInterval)
+	{
+		for (const auto& input : inputs)
+		{
+			if (std::filesystem::exists(output) &&
+			    std::filesystem::equivalent(input, output))
+			{
+				throw std::invalid_argument("Merge output is also an input");
+			}
+		}
+
+		if (threads == 0)
+		{
+			threads = std::max(1u, std::thread::hardware_concurrency());
+		}
+
+		std::vector<MergeSource> sources(inputs.size());
+		parallel_for(inputs.size(), threads, [&](size_t i) {
+			load_merge_source(sources[i], inputs[i], schema, convert);
+		});
+
+		// Lay the output out as RecordWriter would have written it.
+		std::vector<uint64_t> offsets;
+		uint64_t position = record_header_size;
+		uint64_t lastSync = position;
+
+		for (auto& source : sources)
+		{
+			source.start = position;
+			source.first = offsets.size();
+
+			for (const auto& record : source.records)
+			{
+				if (position - lastSync >= syncInterval)
+				{
+					position += record_sync_size;
+					lastSync = position;
+				}
+
+				offsets.push_back(position);
+				position += record_frame_size + record.second;
+			}
+		}
+
+		{
+			std::ofstream stream(output, std::ios::binary | std::ios::trunc);
+			StreamSerializer ser(stream, ByteOrder::MsbFirst);
+			put_record_header(ser, schema);
+
+			stream.close();
+			if (!stream)
+			{
+				throw std::runtime_error("Failed to write record file");
+			}
+		}
+
+		std::filesystem::resize_file(output, position);
+
+		parallel_for(sources.size(), threads, [&](size_t i) {
+			write_merge_source(sources[i], offsets, output);
+		});
+
+		// The index goes last, so an interrupted merge is never mistaken
+		// for a complete one.
+		std::fstream stream(output,
+		                    std::ios::binary | std::ios::in | std::ios::out);
+		stream.seekp(static_cast<std::streamoff>(position));
+
+		StreamSerializer ser(stream, ByteOrder::MsbFirst);
+		put_record_index(ser, offsets, position);
+
+		stream.close();
+		if (!stream)
+		{
+			throw std::runtime_error("Failed to write record file");
+		}
+
+		return offsets.size();
+	}
+} // namespace detail
+
+// Copies the intact records of inputs, in order, into a new record file at
+// output and returns how many were copied. Every input must share the schema
+// of the first; records are copied as they are, without being decoded.
+inline size_t merge_records(const std::vector<std::string>& inputs,
+                            const std::string& output,
+                            unsigned threads    = 0,
+                            size_t syncInterval = 1 << 16)
+{
+	if (inputs.empty())
+	{
+		throw std::invalid_argument("No record files to merge");
+	}
+
+	const uint64_t schema = RecordReader(inputs.front()).schema();
+
+	return detail::merge_records(
+	    inputs, output, schema, nullptr, threads, syncInterval);
+}
+
+// As above, but writes records of T. Inputs with a different schema are
+// decoded as T and encoded again, which suits types such as Tagged that
+// read older encodings.
+template <typename T>
+size_t merge_records(const std::vector<std::string>& inputs,
+                     const std::string& output,
+                     unsigned threads    = 0,
+                     size_t syncInterval = 1 << 16)
+{
+	auto convert = [](const uint8_t* data, size_t size) {
+		T t{};
+		deserialize(t, data, size);
+		return serialize(t);
+	};
+
+	return detail::merge_records(
+	    inputs, output, schema_hash<T>(), convert, threads, syncInterval);
+}
+
+//////////////////
+//// Snapshot ////
+//////////////////
+
+// A snapshot file holds data in the layout it has in memory, so loading it is
+// a matter of mapping it and fixing up its pointers. It is native to the
+// platform that wrote it, and is:
+//
+//   header       "PYXS", u16 version, u8 pointer size, u8 reserved,
+//                u64 schema hash, u64 offset of the root, u64 offset of the
+//                relocation table, u64 number of relocations
+//   data         arrays, strings and the root, each naturally aligned
+//   relocations  u64 offset of each pointer in the data
+//
+// Pointers are written as offsets from the start of the file, and 0 is null.
+// The table only says where pointers are. What they point at is checked
+// against the types they have once the root is asked for.
+
+class SnapshotWriter;
+
+// A read-only array inside a snapshot.
+template <typename T>
+class SnapshotArray
+{
+public:
+	using value_type     = T;
+	using const_iterator = const T*;
+
+	SnapshotArray() = default;
+
+	const T* begin() const noexcept { return data_; }
+
+	const T* end() const noexcept { return data_ + size_; }
+
+	const T* data() const noexcept { return data_; }
+
+	size_t size() const noexcept { return static_cast<size_t>(size_); }
+
+	bool empty() const noexcept { return size_ == 0; }
+
+	const T& operator[](size_t i) const noexcept { return data_[i]; }
+
+private:
+	friend class SnapshotWriter;
+
+	SnapshotArray(uint64_t offset, uint64_t size) noexcept
+	    : data_(reinterpret_cast<const T*>(static_cast<uintptr_t>(offset))),
+	      size_(size)
+	{}
+
+	// Relocation relies on the pointer coming first.
+	const T* data_ = nullptr;
+	uint64_t size_ = 0;
+};
+
+// A read-only, NUL-terminated string inside a snapshot.
+class SnapshotString
+{
+public:
+	SnapshotString() = default;
+
+	const char* data() const noexcept { return data_; }
+
+	const char* c_str() const noexcept { return data_ ? data_ : ""; }
+
+	size_t size() const noexcept { return static_cast<size_t>(size_); }
+
+	bool empty() const noexcept { return size_ == 0; }
+
+	std::string_view view() const noexcept
+	{
+		return std::string_view(c_str(), size());
+	}
+
+	operator std::string_view() const noexcept { return view(); }
+
+private:
+	friend class SnapshotWriter;
+
+	SnapshotString(uint64_t offset, uint64_t size) noexcept
+	    : data_(reinterpret_cast<const char*>(static_cast<uintptr_t>(offset))),
+	      size_(size)
+	{}
+
+	const char* data_ = nullptr;
+	uint64_t size_    = 0;
+};
+
+namespace detail
+{
+	template <typename T>
+	struct has_own_schema<SnapshotArray<T>> : public std::true_type
+	{};
+} // namespace detail
+
+template <typename T>
+struct Schema<SnapshotArray<T>, void, Priority::Primary>
+{
+	static constexpr uint64_t value() noexcept
+	{
+		return detail::schema_combine(detail::schema_seed('j'),
+		                              schema_hash<T>());
+	}
+};
+
+template <>
+struct Schema<SnapshotString, void, Priority::Primary>
+{
+	static constexpr uint64_t value() noexcept
+	{
+		return detail::schema_seed('y');
+	}
+};
+
+namespace detail
+{
+	constexpr uint32_t snapshot_magic   = 0x50595853; // "PYXS"
+	constexpr uint32_t snapshot_swapped = 0x53585950;
+	constexpr uint16_t snapshot_version = 1;
+
+	struct SnapshotHeader
+	{
+		uint32_t magic;
+		uint16_t version;
+		uint8_t pointerSize;
+		uint8_t reserved;
+		uint64_t schema;
+		uint64_t root;
+		uint64_t relocations;
+		uint64_t relocationCount;
+	};
+
+	template <typename T>
+	struct is_snapshot_pointer : public std::false_type
+	{};
+
+	template <typename T>
+	struct is_snapshot_pointer<SnapshotArray<T>> : public std::true_type
+	{};
+
+	template <>
+	struct is_snapshot_pointer<SnapshotString> : public std::true_type
+	{};
+
+	template <typename T>
+	struct is_std_array : public std::false_type
+	{};
+
+	template <typename T, size_t N>
+	struct is_std_array<std::array<T, N>> : public std::true_type
+	{};
+
+	// Hands each array and string held in t, directly or through members
+	// and std::arrays, to f.
+	template <typename T, typename F>
+	void snapshot_pointers(const T& t, F& f)
+	{
+		if constexpr (is_snapshot_pointer<T>::value)
+		{
+			f(t);
+		}
+		else if constexpr (std::is_arithmetic<T>::value ||
+		                   std::is_enum<T>::value)
+		{}
+		else if constexpr (is_std_array<T>::value)
+		{
+			for (const auto& u : t)
+			{
+				snapshot_pointers(u, f);
+			}
+		}
+		else if constexpr (is_member_tieable<T>::value)
+		{
+			std::apply(
+			    [&f](const auto&... u) { (snapshot_pointers(u, f), ...); },
+			    member_tie(t));
+		}
+		else
+		{
+			static_assert(sizeof(T) == 0,
+			              "Type cannot be stored in a snapshot");
+		}
+	}
+
+	// Checks that every array and string a value leads to lies within the
+	// data of a mapped snapshot, is aligned for its elements and, for
+	// strings, ends in NUL. Parts are written before whatever refers to
+	// them, so each must also end before the array holding its referrer;
+	// a cycle can never satisfy that, which bounds the recursion.
+	struct SnapshotChecker
+	{
+		template <typename T>
+		void operator()(const SnapshotArray<T>& a) const
+		{
+			check(a.data(), a.size(), sizeof(T), alignof(T), 0);
+
+			if constexpr (!std::is_arithmetic<T>::value &&
+			              !std::is_enum<T>::value)
+			{
+				const SnapshotChecker inner{
+				    begin, reinterpret_cast<uintptr_t>(a.data())};
+				for (const T& t : a)
+				{
+					snapshot_pointers(t, inner);
+				}
+			}
+		}
+
+		void operator()(const SnapshotString& s) const
+		{
+			check(s.data(), s.size(), 1, 1, 1);
+
+			if (s.data() && s.data()[s.size()] != '\0')
+			{
+				throw std::runtime_error("Snapshot string is not terminated");
+			}
+		}
+
+		void check(const void* data,
+		           uint64_t size,
+		           size_t width,
+		           size_t alignment,
+		           size_t terminator) const
+		{
+			const uintptr_t at = reinterpret_cast<uintptr_t>(data);
+
+			if (data == nullptr ? size != 0
+			                    : at < begin || at > end ||
+			                          end - at < terminator ||
+			                          size > (end - at - terminator) / width ||
+			                          at % alignment != 0)
+			{
+				throw std::runtime_error("Snapshot data out of range");
+			}
+		}
+
+		uintptr_t begin;
+		uintptr_t end;
+	};
+} // namespace detail
+
+/////////////////////////
+//// Snapshot Writer ////
+/////////////////////////
+
+// Writes a snapshot as its parts are added. Each add returns a handle to
+// store in later parts, and finish writes the root that leads to them all.
+// Until then the file has no valid header, so a snapshot cut short is never
+// loaded.
+class SnapshotWriter
+{
+public:
+	explicit SnapshotWriter(const std::string& path);
+
+	SnapshotWriter(const SnapshotWriter&)            = delete;
+	SnapshotWriter& operator=(const SnapshotWriter&) = delete;
+
+	template <typename T>
+	SnapshotArray<T> add(const T* data, size_t size);
+
+	template <typename T>
+	SnapshotArray<T> add(const std::vector<T>& values)
+	{
+		return add(values.data(), values.size());
+	}
+
+	SnapshotString add(std::string_view text);
+
+	template <typename T>
+	void finish(const T& root);
+
+private:
+	template <typename T>
+	uint64_t append(const T* data, size_t size);
+
+	void pad(size_t alignment);
+
+	void write_bytes(const void* data, size_t size);
+
+	std::ofstream stream_;
+	uint64_t position_ = 0;
+	std::vector<uint64_t> slots_;
+	bool open_ = true;
+};
+
+inline SnapshotWriter::SnapshotWriter(const std::string& path)
+    : stream_(path, std::ios::binary | std::ios::out | std::ios::trunc)
+{
+	if (!stream_)
+	{
+		throw std::runtime_error("Failed to open snapshot file");
+	}
+
+	const detail::SnapshotHeader header{};
+	write_bytes(&header, sizeof(header));
+}
+
+template <typename T>
+SnapshotArray<T> SnapshotWriter::add(const T* data, size_t size)
+{
+	if (size == 0)
+	{
+		return {};
+	}
+
+	return SnapshotArray<T>(append(data, size), size);
+}
+
+inline SnapshotString SnapshotWriter::add(std::string_view text)
+{
+	const uint64_t offset = position_;
+
+	write_bytes(text.data(), text.size());
+	write_bytes("", 1);
+
+	return SnapshotString(offset, text.size());
+}
+
+template <typename T>
+void SnapshotWriter::finish(const T& root)
+{
+	if (!open_)
+	{
+		throw std::runtime_error("Snapshot is already finished");
+	}
+
+	detail::SnapshotHeader header{};
+	header.magic       = detail::snapshot_magic;
+	header.version     = detail::snapshot_version;
+	header.pointerSize = sizeof(void*);
+	header.schema      = schema_hash<T>();
+	header.root        = append(&root, 1);
+
+	pad(alignof(uint64_t));
+	header.relocations     = position_;
+	header.relocationCount = slots_.size();
+	write_bytes(slots_.data(), slots_.size() * sizeof(uint64_t));
+
+	stream_.seekp(0);
+	stream_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+	open_ = false;
+	stream_.close();
+	if (!stream_)
+	{
+		throw std::runtime_error("Failed to write snapshot file");
+	}
+}
+
+template <typename T>
+uint64_t SnapshotWriter::append(const T* data, size_t size)
+{
+	static_assert(std::is_trivially_copyable<T>::value &&
+	                  std::is_standard_layout<T>::value,
+	              "Snapshots hold only trivially copyable types");
+
+	pad(alignof(T));
+	const uint64_t offset = position_;
+
+	for (size_t i = 0; i < size; ++i)
+	{
+		const auto* element = reinterpret_cast<const uint8_t*>(data + i);
+		const uint64_t at   = offset + i * sizeof(T);
+
+		auto slot = [&](const auto& pointer) {
+			if (pointer.data())
+			{
+				const auto* p = reinterpret_cast<const uint8_t*>(&pointer);
+				slots_.push_back(at + static_cast<uint64_t>(p - element));
+			}
+		};
+		detail::snapshot_pointers(data[i], slot);
+	}
+	write_bytes(data, size * sizeof(T));
+
+	return offset;
+}
+
+inline void SnapshotWriter::pad(size_t alignment)
+{
+	static const uint8_t zeros[alignof(std::max_align_t)] = {};
+
+	for (size_t pad = (alignment - position_ % alignment) % alignment;
+	     pad != 0;)
+	{
+		const size_t n = pad < sizeof(zeros) ? pad : sizeof(zeros);
+		write_bytes(zeros, n);
+		pad -= n;
+	}
+}
+
+inline void SnapshotWriter::write_bytes(const void* data, size_t size)
+{
+	if (!open_)
+	{
+		throw std::runtime_error("Snapshot is already finished");
+	}
+
+	if (!stream_.write(static_cast<const char*>(data),
+	                   static_cast<std::streamsize>(size)))
+	{
+		throw std::runtime_error("Failed to write snapshot file");
+	}
+
+	position_ += size;
+}
+
+/////////////////////////
+//// Snapshot Reader ////
+/////////////////////////
+
+// Maps a snapshot and points its pointers at the mapping, touching nothing
+// but the pages that hold them. The rest is shared with the page cache and
+// read only when used. Everything returned lives as long as the reader.
+class SnapshotReader
+{
+public:
+	explicit SnapshotReader(const std::string& path);
+
+	uint64_t schema() const noexcept { return header_.schema; }
+
+	// Checks the schema, then that every array and string the root leads to
+	// lies within the data, is aligned and, for strings, ends in NUL. That
+	// reads each struct holding pointers and the end of each string, so keep
+	// the reference rather than asking again.
+	template <typename T>
+	const T& root() const;
+
+private:
+	detail::MappedFile file_;
+	detail::SnapshotHeader header_;
+};
+
+inline SnapshotReader::SnapshotReader(const std::string& path)
+    : file_(path, true)
+{
+	constexpr uint64_t headerSize = sizeof(detail::SnapshotHeader);
+
+	if (file_.size() < headerSize)
+	{
+		throw std::runtime_error("Not a snapshot file");
+	}
+
+	std::memcpy(&header_, file_.data(), headerSize);
+
+	if (header_.magic != detail::snapshot_magic)
+	{
+		throw std::runtime_error(
+		    header_.magic == detail::snapshot_swapped
+		        ? "Snapshot was written with another byte order"
+		        : "Not a snapshot file");
+	}
+	if (header_.version != detail::snapshot_version)
+	{
+		throw std::runtime_error("Unsupported snapshot file version");
+	}
+	if (header_.pointerSize != sizeof(void*))
+	{
+		throw std::runtime_error("Snapshot was written with another "
+		                         "pointer size");
+	}
+
+	const uint64_t end = header_.relocations;
+	if (end < headerSize || end > file_.size() || end % sizeof(uint64_t) ||
+	    header_.relocationCount > (file_.size() - end) / sizeof(uint64_t))
+	{
+		throw std::runtime_error("Snapshot relocations out of range");
+	}
+
+	uint8_t* base        = file_.data();
+	const uint64_t* slot = reinterpret_cast<const uint64_t*>(base + end);
+
+	for (uint64_t i = 0; i < header_.relocationCount; ++i)
+	{
+		const uint64_t at = slot[i];
+		if (at < headerSize || at > end - sizeof(uintptr_t) ||
+		    at % alignof(uintptr_t))
+		{
+			throw std::runtime_error("Snapshot relocations out of range");
+		}
+
+		uintptr_t& pointer = *reinterpret_cast<uintptr_t*>(base + at);
+		if (pointer < headerSize || pointer >= end)
+		{
+			throw std::runtime_error("Snapshot relocations out of range");
+		}
+
+		pointer += reinterpret_cast<uintptr_t>(base);
+	}
+
+	file_.seal();
+}
+
+template <typename T>
+const T& SnapshotReader::root() const
+{
+	if (header_.schema != schema_hash<T>())
+	{
+		throw std::runtime_error("Schema of snapshot does not match");
+	}
+
+	const uint64_t at = header_.root;
+	const uint64_t end = header_.relocations;
+	if (at < sizeof(detail::SnapshotHeader) || sizeof(T) > end ||
+	    at > end - sizeof(T) || at % alignof(T))
+	{
+		throw std::runtime_error("Snapshot root out of range");
+	}
+
+	const T& root = *reinterpret_cast<const T*>(file_.data() + at);
+
+	const uintptr_t base = reinterpret_cast<uintptr_t>(file_.data());
+	const detail::SnapshotChecker checker{
+	    base + sizeof(detail::SnapshotHeader), base + at};
+	detail::snapshot_pointers(root, checker);
+
+	return root;
+}
+
+} // namespace pyxi
+
+#endif
@@ -1,10 +1,23 @@
 #include <gtest/gtest.h>
 
 #include <array>
+#include <cstring>
+#include <deque>
+#include <limits>
+#include <map>
 #include <pyxi.hpp>
+#include <set>
 #include <string>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 
+#if PYXI_CXX >= 17
+#include <filesystem>
+#include <fstream>
+#include <pyxi_record.hpp>
+#endif
+
 #define CAT2(x, y) x##y
 #define CAT(x, y)  CAT2(x, y)
 
@@ -38,6 +51,14 @@ TEST(trait, is_iterable)
 	EXPECT_TRUE_V(is_iterable, std::vector<int>);
 }
 
+TEST(trait, is_associative)
+{
+	EXPECT_FALSE_V(is_associative, std::vector<int>);
+	EXPECT_TRUE_V(is_associative, std::set<int>);
+	EXPECT_TRUE_V(is_associative, std::map<int, int>);
+	EXPECT_TRUE_V(is_associative, std::unordered_map<int, int>);
+}
+
 struct HasSerializer
 {
 	void serialize(Serializer&) const;
@@ -129,6 +150,22 @@ struct Flags
 	Bits<uint8_t, 2> b;
 };
 
+struct Forwarding
+{
+	Forwarding() = default;
+
+	template <typename U>
+	Forwarding(U&&)
+	{}
+};
+
+struct Forwarded
+{
+	int a;
+	Forwarding b;
+	int c;
+};
+
 TEST(trait, member_count)
 {
 	size_t count;
@@ -146,6 +183,20 @@ TEST(trait, member_count)
 	EXPECT_EQ(count, 30);
 }
 
+TEST(trait, member_count_forwarding)
+{
+	// A member that can be built from anything must not end the count.
+	const size_t count = member_count<Forwarded>::value;
+	EXPECT_EQ(count, 3);
+}
+
+struct Nested
+{
+	Trio trio;
+	uint16_t values[3];
+	std::string name;
+};
+
 TEST(trait, member_offsets)
 {
 	auto offsets = member_offsets<Trio>::value();
@@ -154,6 +205,26 @@ TEST(trait, member_offsets)
 	EXPECT_EQ(offsets[0], 0);
 	EXPECT_EQ(offsets[1], 4);
 	EXPECT_EQ(offsets[2], 5);
+
+	auto nested = member_offsets<Nested>::value();
+	ASSERT_EQ(nested.size(), 5);
+
+	EXPECT_EQ(nested[1], offsetof(Nested, values));
+	EXPECT_EQ(nested[3], offsetof(Nested, values) + 2 * sizeof(uint16_t));
+	EXPECT_EQ(nested[4], offsetof(Nested, name));
+}
+
+TEST(trait, schema_hash)
+{
+	EXPECT_EQ(schema_hash<Trio>(), schema_hash<Trio>());
+	EXPECT_NE(schema_hash<int32_t>(), schema_hash<uint32_t>());
+	EXPECT_NE(schema_hash<std::vector<uint8_t>>(), schema_hash<uint8_t>());
+	EXPECT_NE((schema_hash<Bits<uint8_t, 3>>()),
+	          (schema_hash<Bits<uint8_t, 4>>()));
+	EXPECT_NE(schema_hash<Trio>(),
+	          (schema_hash<std::tuple<uint32_t, char, bool>>()));
+	EXPECT_EQ((schema_hash<std::vector<std::pair<Trio, Flags>>>()),
+	          (schema_hash<std::vector<std::pair<Trio, Flags>>>()));
 }
 
 TEST(serialize, trio_lsb)
@@ -206,6 +277,201 @@ TEST(serialize, flags)
 	EXPECT_EQ(bytes[0], 0b10010000);
 }
 
+TEST(serialize, partial_byte)
+{
+	// Whole bytes are laid out as before. The bits of a trailing partial
+	// byte used to be written one position up from the end of the byte,
+	// as 0x0a, 0x50 and 0x18 below, and now fill it from the front.
+	EXPECT_EQ(serialize(Bits<uint8_t, 3>(5), ByteOrder::MsbFirst),
+	          (std::vector<uint8_t>{0xa0}));
+	EXPECT_EQ(serialize(Bits<uint8_t, 3>(5), ByteOrder::LsbFirst),
+	          (std::vector<uint8_t>{0x05}));
+	EXPECT_EQ(serialize(Bits<uint16_t, 12>(0xabc), ByteOrder::MsbFirst),
+	          (std::vector<uint8_t>{0xab, 0xc0}));
+
+	Bits<uint8_t, 3> msb;
+	deserialize(msb, std::vector<uint8_t>{0xa0}, ByteOrder::MsbFirst);
+	EXPECT_EQ(*msb, 5);
+
+	Bits<uint8_t, 3> lsb;
+	deserialize(lsb, std::vector<uint8_t>{0x05}, ByteOrder::LsbFirst);
+	EXPECT_EQ(*lsb, 5);
+}
+
+struct Framed
+{
+	Bits<uint8_t, 3> kind;
+	Align<8> payload;
+	std::vector<uint16_t> values;
+	Align<32> end;
+};
+
+TEST(serialize, align)
+{
+	Framed frame{5, {}, {0x1234, 0x5678}, {}};
+
+	auto bytes = serialize(frame);
+
+	// kind, padding to the byte, values.size(), values, padding to 32 bits
+	ASSERT_EQ(bytes.size(), 1 + sizeof(size_t) + 4 + 3);
+	EXPECT_EQ(bytes[0], 0b10100000);
+	EXPECT_EQ(bytes[sizeof(size_t)], 2);
+	EXPECT_EQ(bytes[1 + sizeof(size_t)], 0x12);
+
+	Framed target{};
+	deserialize(target, bytes);
+	EXPECT_EQ(*target.kind, 5);
+	EXPECT_EQ(target.values, frame.values);
+
+	std::vector<uint8_t> data = {1, 2, 3, 4, 5};
+	align(data, 4);
+	EXPECT_EQ(data, (std::vector<uint8_t>{1, 2, 3, 4, 5, 0, 0, 0}));
+	EXPECT_EQ(align({1, 2, 3, 4}, 4).size(), 4);
+}
+
+struct Entry
+{
+	uint8_t kind;
+	uint32_t id;
+	uint16_t weight;
+};
+
+TEST(serialize, natural)
+{
+	Entry entry;
+	std::memset(&entry, 0xaa, sizeof(entry));
+	entry.kind   = 1;
+	entry.id     = 2;
+	entry.weight = 3;
+
+	DynamicSerializer ser(ByteOrder::MsbFirst);
+	ser << Bits<uint8_t, 3>(5) << Natural<Entry>(entry);
+	ser.flush();
+
+	// Padded to the alignment of Entry, then its memory image with the
+	// padding zeroed.
+	ASSERT_EQ(ser.data().size(), alignof(Entry) + sizeof(Entry));
+
+	Entry expected{};
+	expected.kind   = 1;
+	expected.id     = 2;
+	expected.weight = 3;
+
+	EXPECT_EQ(std::memcmp(ser.data().data() + alignof(Entry),
+	                      &expected,
+	                      sizeof(Entry)),
+	          0);
+}
+
+TEST(roundtrip, natural)
+{
+	const std::vector<Entry> table = {{1, 10, 100}, {2, 20, 200}};
+
+	DynamicSerializer ser(ByteOrder::MsbFirst);
+	ser << Natural<uint8_t>(7) << Natural<std::vector<Entry>>(table)
+	    << Natural<double>(2.5);
+	ser.flush();
+
+	Natural<uint8_t> a;
+	Natural<std::vector<Entry>> b;
+	Natural<double> c;
+
+	BufferDeserializer des(
+	    ser.data().data(), ser.data().size(), ByteOrder::MsbFirst);
+	des >> a >> b >> c;
+
+	EXPECT_EQ(*a, 7);
+	ASSERT_EQ(b->size(), 2);
+	EXPECT_EQ((*b)[1].weight, 200);
+	EXPECT_EQ(*c, 2.5);
+
+	NaturalReader reader(ser.data().data(), ser.data().size());
+	EXPECT_EQ(reader.next<uint8_t>(), 7);
+
+	auto entries = reader.next_array<Entry>();
+	ASSERT_EQ(entries.second, 2);
+	EXPECT_EQ(entries.first[0].id, 10);
+	EXPECT_EQ(entries.first[1].kind, 2);
+	EXPECT_EQ(reinterpret_cast<const uint8_t*>(entries.first) -
+	              ser.data().data(),
+	          16);
+
+	EXPECT_EQ(reader.next<double>(), 2.5);
+	EXPECT_EQ(reader.tell(), ser.data().size());
+	EXPECT_THROW(reader.next<uint8_t>(), std::out_of_range);
+}
+
+TEST(serialize, give_many)
+{
+	const uint16_t values[3] = {0x1234, 0x5678, 0x9abc};
+
+	for (ByteOrder order : {ByteOrder::MsbFirst, ByteOrder::LsbFirst})
+	{
+		for (size_t lead : {0, 3})
+		{
+			DynamicSerializer many(order);
+			DynamicSerializer one(order);
+
+			if (lead != 0)
+			{
+				many.give<uint8_t>(0b101, lead);
+				one.give<uint8_t>(0b101, lead);
+			}
+
+			many.give_many(values, 3);
+			many.give_many(values, 3, 12);
+			many.flush();
+
+			for (uint16_t v : values)
+			{
+				one.give(v);
+			}
+			for (uint16_t v : values)
+			{
+				one.give(v, 12);
+			}
+			one.flush();
+
+			EXPECT_EQ(many.data(), one.data());
+			EXPECT_EQ(many.tell(), one.tell());
+		}
+	}
+}
+
+TEST(serialize, write_bytes)
+{
+	const uint8_t block[3] = {0xde, 0xad, 0xbe};
+
+	for (ByteOrder order : {ByteOrder::MsbFirst, ByteOrder::LsbFirst})
+	{
+		for (size_t lead : {0, 1, 5})
+		{
+			DynamicSerializer bytes(order);
+			DynamicSerializer one(order);
+
+			if (lead != 0)
+			{
+				bytes.give<uint8_t>(0b10011, lead);
+				one.give<uint8_t>(0b10011, lead);
+			}
+
+			bytes.write_bytes(block, 3);
+			bytes.give<uint8_t>(0b1, 1);
+			bytes.flush();
+
+			for (uint8_t b : block)
+			{
+				one.give(b);
+			}
+			one.give<uint8_t>(0b1, 1);
+			one.flush();
+
+			EXPECT_EQ(bytes.data(), one.data());
+			EXPECT_EQ(bytes.tell(), one.tell());
+		}
+	}
+}
+
 TEST(deserialize, uint32_msb)
 {
 	std::vector<uint8_t> buffer = {0x12, 0x34, 0x56, 0x78};
@@ -231,6 +497,69 @@ TEST(deserialize, int8)
 	EXPECT_EQ(v, -5);
 }
 
+TEST(deserialize, skip)
+{
+	std::vector<uint8_t> buffer = {0x12, 0x34, 0x56, 0x78};
+	BufferDeserializer des(buffer.data(), buffer.size(), ByteOrder::MsbFirst);
+
+	EXPECT_EQ(des.take<uint8_t>(4), 0x1);
+	des.skip(12);
+	EXPECT_EQ(des.take<uint8_t>(), 0x56);
+	EXPECT_EQ(des.tell(), 24);
+
+	EXPECT_THROW(des.skip(9), std::out_of_range);
+}
+
+TEST(deserialize, take_many)
+{
+	std::vector<uint8_t> buffer = {0x12, 0x34, 0x56, 0x78, 0x9a};
+
+	uint16_t msb[2];
+	BufferDeserializer des(buffer.data(), buffer.size(), ByteOrder::MsbFirst);
+	des.take_many(msb, 2);
+	EXPECT_EQ(msb[0], 0x1234);
+	EXPECT_EQ(msb[1], 0x5678);
+
+	int8_t nibbles[2];
+	des.take_many(nibbles, 2, 4);
+	EXPECT_EQ(nibbles[0], -7);
+	EXPECT_EQ(nibbles[1], -6);
+	EXPECT_EQ(des.tell(), 40);
+
+	uint16_t lsb[2];
+	BufferDeserializer other(buffer.data(), 4, ByteOrder::LsbFirst);
+	other.take_many(lsb, 2);
+	EXPECT_EQ(lsb[0], 0x3412);
+	EXPECT_EQ(lsb[1], 0x7856);
+
+	EXPECT_THROW(other.take_many(lsb, 1), std::out_of_range);
+}
+
+TEST(deserialize, read_bytes)
+{
+	std::vector<uint8_t> buffer = {0x12, 0x34, 0x56, 0x78};
+
+	for (ByteOrder order : {ByteOrder::MsbFirst, ByteOrder::LsbFirst})
+	{
+		BufferDeserializer bytes(buffer.data(), buffer.size(), order);
+		BufferDeserializer one(buffer.data(), buffer.size(), order);
+
+		EXPECT_EQ(bytes.take<uint8_t>(3), one.take<uint8_t>(3));
+
+		uint8_t block[3];
+		bytes.read_bytes(block, 3);
+		for (uint8_t b : block)
+		{
+			EXPECT_EQ(b, one.take<uint8_t>());
+		}
+
+		EXPECT_EQ(bytes.take<uint8_t>(5), one.take<uint8_t>(5));
+		EXPECT_EQ(bytes.tell(), 32);
+
+		EXPECT_THROW(bytes.read_bytes(block, 1), std::out_of_range);
+	}
+}
+
 TEST(roundtrip, flags)
 {
 	Flags flags{{}, 1, 2};
@@ -245,6 +574,21 @@ TEST(roundtrip, flags)
 	EXPECT_EQ(*flags.b, 2);
 }
 
+TEST(roundtrip, nested)
+{
+	Nested nested{{0x12345678, true, 'c'}, {1, 2, 3}, "nested"};
+
+	auto bytes = serialize(nested);
+	ASSERT_EQ(bytes.size(), 6 + 6 + sizeof(size_t) + 6);
+
+	Nested target = deserialize<Nested>(bytes);
+	EXPECT_EQ(target.trio.a, 0x12345678);
+	EXPECT_EQ(target.trio.b, true);
+	EXPECT_EQ(target.trio.c, 'c');
+	EXPECT_EQ(target.values[2], 3);
+	EXPECT_EQ(target.name, "nested");
+}
+
 TEST(roundtrip, float)
 {
 	float v = -1.25f;
@@ -257,3 +601,1235 @@ TEST(roundtrip, float)
 
 	EXPECT_EQ(v, -1.25f);
 }
+
+TEST(serialize, half)
+{
+	const std::pair<float, uint16_t> cases[] = {
+	    {1.0f, 0x3c00},
+	    {-2.0f, 0xc000},
+	    {0.1f, 0x2e66},
+	    {65504.0f, 0x7bff},
+	    {1e6f, 0x7c00},
+	    {5.9604645e-8f, 0x0001},
+	    {2e-8f, 0x0000},
+	};
+
+	for (const auto& c : cases)
+	{
+		auto bytes = serialize(Half<float>(c.first));
+		ASSERT_EQ(bytes.size(), 2);
+		EXPECT_EQ(bytes[0] << 8 | bytes[1], c.second);
+	}
+}
+
+TEST(roundtrip, half)
+{
+	std::vector<Half<float>> v(300);
+	for (size_t i = 0; i < v.size(); ++i)
+	{
+		v[i] = static_cast<float>(i) / 8 - 10;
+	}
+
+	auto bytes = serialize(v);
+	ASSERT_EQ(bytes.size(), sizeof(size_t) + 2 * v.size());
+
+	std::vector<Half<float>> target;
+	deserialize(target, bytes);
+
+	ASSERT_EQ(target.size(), v.size());
+	for (size_t i = 0; i < v.size(); ++i)
+	{
+		EXPECT_EQ(*target[i], *v[i]);
+	}
+
+	std::array<Half<float>, 3> a = {1.5f, -0.25f, 3e-6f};
+	std::array<Half<float>, 3> b = {};
+	deserialize(b, serialize(a));
+
+	EXPECT_EQ(*b[0], 1.5f);
+	EXPECT_EQ(*b[1], -0.25f);
+	EXPECT_NEAR(*b[2], 3e-6f, 3e-8f);
+}
+
+TEST(roundtrip, quantized)
+{
+	using Temperature = Quantized<float, 12, std::ratio<-40>, std::ratio<85>>;
+
+	DynamicSerializer ser(ByteOrder::MsbFirst);
+	for (float v : {-40.0f, 21.37f, 85.0f, 200.0f, -1e9f})
+	{
+		ser << Temperature(v);
+	}
+	ser.flush();
+
+	ASSERT_EQ(ser.data().size(), (5 * 12 + 7) / 8);
+
+	BufferDeserializer des(
+	    ser.data().data(), ser.data().size(), ByteOrder::MsbFirst);
+	Temperature t;
+
+	des >> t;
+	EXPECT_EQ(*t, -40.0f);
+	des >> t;
+	EXPECT_NEAR(*t, 21.37f, Temperature::step() / 2);
+	des >> t;
+	EXPECT_EQ(*t, 85.0f);
+	des >> t;
+	EXPECT_EQ(*t, 85.0f);
+	des >> t;
+	EXPECT_EQ(*t, -40.0f);
+}
+
+TEST(serialize, time_series)
+{
+	TimeSeries<std::vector<double>> series = std::vector<double>{1, 1, 2};
+
+	auto bytes = serialize(series);
+
+	// size, first value, 1 bit for the repeat, then 2 + 5 + 6 control bits
+	// and the 11 bits where 1.0 and 2.0 differ
+	ASSERT_EQ(bytes.size(), (bitsize<size_t>::value + 64 + 1 + 24 + 7) / 8);
+	EXPECT_EQ(bytes[sizeof(size_t)], 0x3f);
+	EXPECT_EQ(bytes[sizeof(size_t) + 8], 0b01100001);
+	EXPECT_EQ(bytes[sizeof(size_t) + 9], 0b00101011);
+}
+
+TEST(roundtrip, time_series)
+{
+	std::vector<double> values;
+	for (int i = 0; i < 1000; ++i)
+	{
+		values.push_back(20 + (i % 50) * 0.25);
+	}
+	values[10] = -0.0;
+	values[11] = std::numeric_limits<double>::infinity();
+	values[12] = 1e-310;
+
+	TimeSeries<std::vector<double>> series = values;
+
+	auto bytes = serialize(series);
+	EXPECT_LT(bytes.size(), values.size() * sizeof(double) / 3);
+
+	TimeSeries<std::vector<double>> target = std::vector<double>(5, 1.0);
+	deserialize(target, bytes);
+
+	ASSERT_EQ(target->size(), values.size());
+	EXPECT_EQ(std::memcmp(target->data(), values.data(), 8 * values.size()),
+	          0);
+
+	TimeSeries<std::deque<float>> floats = std::deque<float>{1.5f, 1.5f, -3};
+	EXPECT_EQ(*deserialize<decltype(floats)>(serialize(floats)), *floats);
+}
+
+TEST(serialize, huffman)
+{
+	// 'a' takes 1 bit, 'b' 2 and 'c' and 'd' 3 each.
+	Huffman<std::string> text = std::string("aaaabbcd");
+
+	auto bytes = serialize(text);
+
+	// size, 4 symbols, 4 table entries, bit count, 4 + 4 + 6 code bits
+	ASSERT_EQ(bytes.size(), sizeof(size_t) + 1 + 4 * 12 / 8 + 1 + 2);
+	EXPECT_EQ(bytes[sizeof(size_t)], 4);
+	EXPECT_EQ(bytes[sizeof(size_t) + 7], 14);
+	EXPECT_EQ(bytes[sizeof(size_t) + 8], 0b00001010);
+	EXPECT_EQ(bytes[sizeof(size_t) + 9], 0b11011100);
+
+	Huffman<std::string> same = std::string(100, 'x');
+	EXPECT_EQ(serialize(same).size(), sizeof(size_t) + 1 + 1);
+}
+
+TEST(roundtrip, huffman)
+{
+	std::vector<uint8_t> labels;
+	for (size_t i = 0; i < 5000; ++i)
+	{
+		labels.push_back(static_cast<uint8_t>(
+		    i % 2 == 0 ? 0 : i % 3 == 0 ? 1 : i % 7 == 0 ? 2 : i % 11));
+	}
+
+	Huffman<std::vector<uint8_t>> column = labels;
+
+	auto bytes = serialize(column);
+	EXPECT_LT(bytes.size(), labels.size() * 3 / 8);
+
+	Huffman<std::vector<uint8_t>> target;
+	deserialize(target, bytes);
+	EXPECT_EQ(*target, labels);
+
+	// Counts that would need codes longer than 16 bits are flattened.
+	std::vector<int16_t> skewed;
+	for (size_t s = 0, a = 1, b = 1; s < 24; ++s, b += a, a = b - a)
+	{
+		skewed.insert(skewed.end(), a, static_cast<int16_t>(-s));
+	}
+
+	Huffman<std::vector<int16_t>> wide = skewed;
+	EXPECT_EQ(*deserialize<decltype(wide)>(serialize(wide)), skewed);
+
+	// Two symbols take a bit each, so 64 of them fill exactly one word.
+	for (size_t count : {64, 128})
+	{
+		std::string bits(count, 'a');
+		std::fill(bits.begin(), bits.begin() + count / 2, 'b');
+
+		Huffman<std::string> whole = bits;
+		EXPECT_EQ(*deserialize<decltype(whole)>(serialize(whole)), bits);
+	}
+
+	bytes.resize(bytes.size() - 2);
+	EXPECT_THROW(deserialize(target, bytes), std::out_of_range);
+}
+
+TEST(deserialize, reuse_storage)
+{
+	std::vector<std::string> v = {"a string too long for small buffers",
+	                              "another string too long for small buffers"};
+
+	auto bytes = serialize(v);
+
+	std::vector<std::string> target = v;
+	target[0]                       = "short";
+
+	const char* first           = target[0].data();
+	const char* second          = target[1].data();
+	const std::string* elements = target.data();
+
+	deserialize(target, bytes);
+
+	EXPECT_EQ(target, v);
+	EXPECT_EQ(target.data(), elements);
+	EXPECT_EQ(target[0].data(), first);
+	EXPECT_EQ(target[1].data(), second);
+}
+
+TEST(trait, is_reservable)
+{
+	EXPECT_FALSE_V(is_reservable, int);
+	EXPECT_FALSE_V(is_reservable, std::array<int, 5>);
+	EXPECT_TRUE_V(is_reservable, std::string);
+	EXPECT_TRUE_V(is_reservable, std::vector<int>);
+}
+
+TEST(roundtrip, vector_trivial)
+{
+	std::vector<uint64_t> v = {1, 0x123456789abcdef0, 3};
+
+	auto bytes = serialize(v);
+	ASSERT_EQ(bytes.size(), sizeof(size_t) + 3 * sizeof(uint64_t));
+
+	std::vector<uint64_t> target = {7, 8, 9, 10, 11};
+	deserialize(target, bytes);
+
+	EXPECT_EQ(target, v);
+}
+
+TEST(roundtrip, map)
+{
+	std::map<uint16_t, std::string> m = {{3, "three"}, {1, "one"}, {2, "two"}};
+
+	auto bytes = serialize(m);
+
+	std::map<uint16_t, std::string> target = {{4, "four"}};
+	deserialize(target, bytes);
+
+	EXPECT_EQ(target, m);
+}
+
+TEST(roundtrip, unordered_map)
+{
+	std::unordered_map<std::string, uint32_t> m = {{"a", 1}, {"b", 2}};
+
+	auto bytes = serialize(m);
+
+	EXPECT_EQ(deserialize<decltype(m)>(bytes), m);
+}
+
+TEST(roundtrip, set)
+{
+	std::set<int32_t> s = {-4, 0, 7};
+
+	auto bytes = serialize(s);
+	ASSERT_EQ(bytes.size(), sizeof(size_t) + 3 * sizeof(int32_t));
+
+	EXPECT_EQ(deserialize<decltype(s)>(bytes), s);
+}
+
+TEST(roundtrip, bool_array)
+{
+	std::array<bool, 3> flags{{true, false, true}};
+	std::vector<uint16_t> codes{1, 0xffff, 300};
+
+	auto flagsCopy = flags;
+	auto codesCopy = codes;
+	flagsCopy.fill(false);
+	codesCopy.assign(5, 0);
+
+	deserialize(flagsCopy, serialize(flags));
+	deserialize(codesCopy, serialize(codes));
+	EXPECT_EQ(flagsCopy, flags);
+	EXPECT_EQ(codesCopy, codes);
+}
+
+struct Point
+{
+	float x;
+	float y;
+	int32_t z;
+};
+
+struct Loose
+{
+	uint8_t kind;
+	uint32_t id;
+};
+
+TEST(roundtrip, bulk_elements)
+{
+	std::vector<double> values;
+	std::vector<Point> points;
+	std::vector<Loose> loose;
+	for (int i = 0; i < 300; ++i)
+	{
+		values.push_back(i * 0.25);
+		points.push_back(Point{i * 0.5f, -i * 1.5f, -i});
+		loose.push_back(Loose{static_cast<uint8_t>(i), 1000u + i});
+	}
+
+	// Contiguous runs encode exactly as the same elements one by one.
+	for (ByteOrder order : {ByteOrder::MsbFirst, ByteOrder::LsbFirst})
+	{
+		std::deque<double> valueQueue(values.begin(), values.end());
+		std::deque<Point> pointQueue(points.begin(), points.end());
+		std::deque<Loose> looseQueue(loose.begin(), loose.end());
+
+		EXPECT_EQ(serialize(values, order), serialize(valueQueue, order));
+		EXPECT_EQ(serialize(points, order), serialize(pointQueue, order));
+		EXPECT_EQ(serialize(loose, order), serialize(looseQueue, order));
+	}
+
+	// Decoding over fewer elements, then more, than were encoded.
+	std::vector<double> valueCopy(10);
+	std::vector<Point> pointCopy(10);
+	deserialize(valueCopy, serialize(values));
+	deserialize(pointCopy, serialize(points));
+	EXPECT_EQ(valueCopy, values);
+	ASSERT_EQ(pointCopy.size(), points.size());
+	EXPECT_EQ(pointCopy[299].y, points[299].y);
+	EXPECT_EQ(pointCopy[299].z, -299);
+
+	std::vector<float> floats{1.5f, -2.0f};
+	std::vector<float> floatCopy(5, 9.0f);
+	deserialize(floatCopy, serialize(floats));
+	EXPECT_EQ(floatCopy, floats);
+
+	std::vector<Loose> looseCopy;
+	deserialize(looseCopy, serialize(loose));
+	ASSERT_EQ(looseCopy.size(), loose.size());
+	EXPECT_EQ(looseCopy[299].id, 1299);
+}
+
+TEST(roundtrip, pair_tuple)
+{
+	std::pair<uint8_t, std::string> p = {7, "seven"};
+	std::tuple<uint16_t, bool, std::vector<int8_t>> t{512, true, {-1, 1}};
+
+	EXPECT_EQ(deserialize<decltype(p)>(serialize(p)), p);
+	EXPECT_EQ(deserialize<decltype(t)>(serialize(t)), t);
+}
+
+struct RecordV1
+{
+	uint32_t id;
+	std::string name;
+};
+
+struct RecordV2
+{
+	uint32_t id;
+	std::string name;
+	uint16_t flags;
+};
+
+TEST(roundtrip, tagged)
+{
+	Tagged<RecordV2> v2 = RecordV2{7, "name", 0xbeef};
+
+	auto bytes = serialize(v2);
+
+	Tagged<RecordV1> v1 = deserialize<Tagged<RecordV1>>(bytes);
+	EXPECT_EQ(v1->id, 7);
+	EXPECT_EQ(v1->name, "name");
+
+	v1->name = "renamed";
+	bytes    = serialize(v1);
+
+	deserialize(v2, bytes);
+	EXPECT_EQ(v2->id, 7);
+	EXPECT_EQ(v2->name, "renamed");
+	EXPECT_EQ(v2->flags, 0xbeef);
+}
+
+struct Envelope
+{
+	Tagged<RecordV1> record;
+	std::vector<uint16_t> codes;
+};
+
+TEST(roundtrip, tagged_nested)
+{
+	Tagged<Envelope> envelope = Envelope{RecordV1{9, "inner"}, {1, 300, 7}};
+
+	auto copy = deserialize<Tagged<Envelope>>(serialize(envelope));
+	EXPECT_EQ(copy->record->id, 9);
+	EXPECT_EQ(copy->record->name, "inner");
+	EXPECT_EQ(copy->codes, envelope->codes);
+}
+
+TEST(deserialize, tagged_overlong_varint)
+{
+	std::vector<uint8_t> bytes(9, 0xff);
+	bytes.push_back(0x02);
+
+	EXPECT_THROW(deserialize<Tagged<RecordV1>>(bytes), std::out_of_range);
+}
+
+TEST(roundtrip, schema)
+{
+	DynamicSerializer ser(ByteOrder::MsbFirst);
+	write_schema<RecordV1>(ser);
+	ser.flush();
+
+	BufferDeserializer des(ser.data().data(), 8, ByteOrder::MsbFirst);
+	EXPECT_NO_THROW(check_schema<RecordV1>(des));
+
+	BufferDeserializer other(ser.data().data(), 8, ByteOrder::MsbFirst);
+	EXPECT_THROW(check_schema<RecordV2>(other), std::runtime_error);
+}
+
+TEST(serialize, preencoded)
+{
+	for (ByteOrder order : {ByteOrder::MsbFirst, ByteOrder::LsbFirst})
+	{
+		using Header = std::pair<Trio, Bits<uint8_t, 3>>;
+
+		Header header{{0x12345678, true, 'x'}, 0b101};
+		Preencoded<Header, ByteOrder::MsbFirst> msb = header;
+		Preencoded<Header, ByteOrder::LsbFirst> lsb = header;
+
+		Bits<uint8_t, 5> lead = 0b10110;
+
+		auto expected = serialize(std::make_tuple(lead, header), order);
+		EXPECT_EQ(serialize(std::make_tuple(lead, msb), order), expected);
+		EXPECT_EQ(serialize(std::make_tuple(lead, lsb), order), expected);
+	}
+}
+
+TEST(roundtrip, preencoded)
+{
+	Preencoded<Trio> trio = Trio{1, false, 'a'};
+	EXPECT_EQ(trio.bits(), 48);
+
+	auto result = deserialize<Preencoded<Trio>>(serialize(trio));
+	EXPECT_EQ(result->a, 1);
+	EXPECT_EQ(result->c, 'a');
+
+	trio->c = 'b';
+	EXPECT_EQ(trio.bytes(), serialize(*trio));
+
+	result = deserialize<Preencoded<Trio>>(serialize(trio));
+	EXPECT_EQ(result->c, 'b');
+}
+
+TEST(serialize, preencoded_shared)
+{
+	const Preencoded<Trio> trio = Trio{0x01020304, true, 'z'};
+
+	std::vector<std::vector<uint8_t>> results(4);
+	std::vector<std::thread> threads;
+
+	for (auto& result : results)
+	{
+		threads.emplace_back([&trio, &result] { result = serialize(trio); });
+	}
+
+	for (auto& thread : threads)
+	{
+		thread.join();
+	}
+
+	for (const auto& result : results)
+	{
+		EXPECT_EQ(result, serialize(*trio));
+	}
+}
+
+struct Padded
+{
+	Bits<uint8_t, 3> kind;
+	Align<32> pad;
+	uint8_t value;
+};
+
+struct PaddedRun
+{
+	Bits<uint8_t, 3> kind;
+	Align<32> pad;
+	std::array<uint8_t, 20> values;
+};
+
+struct Paddings
+{
+	Padded head;
+	PaddedRun run;
+};
+
+TEST(roundtrip, tagged_align)
+{
+	Tagged<Padded> padded = Padded{5, {}, 0x77};
+	EXPECT_EQ(deserialize<Tagged<Padded>>(serialize(padded))->value, 0x77);
+
+	// The run is long enough for a two byte length, which moves it by a
+	// byte after it was first laid out.
+	Tagged<Paddings> paddings = Paddings{{3, {}, 0x11}, {6, {}, {}}};
+	paddings->run.values.fill(0x5a);
+
+	using Message = std::tuple<Bits<uint8_t, 3>, Tagged<Paddings>>;
+	Message message(Bits<uint8_t, 3>(2), paddings);
+
+	Message result;
+	deserialize(result, serialize(message));
+	EXPECT_EQ(*std::get<0>(result), 2);
+	EXPECT_EQ(std::get<1>(result)->head.value, 0x11);
+	EXPECT_EQ(*std::get<1>(result)->run.kind, 6);
+	EXPECT_EQ(std::get<1>(result)->run.values, paddings->run.values);
+}
+
+TEST(serialize, preencoded_align)
+{
+	const Bits<uint8_t, 3> lead = 5;
+
+	Padded padded{2, {}, 0x77};
+	Preencoded<Padded> preencoded = padded;
+
+	auto bytes = serialize(std::make_tuple(lead, preencoded));
+	EXPECT_EQ(bytes, serialize(std::make_tuple(lead, padded)));
+
+	std::tuple<Bits<uint8_t, 3>, Padded> result;
+	deserialize(result, bytes);
+	EXPECT_EQ(std::get<1>(result).value, 0x77);
+
+	Entry entry{1, 2, 3};
+	Preencoded<Natural<Entry>> natural = Natural<Entry>(entry);
+	EXPECT_EQ(serialize(std::make_tuple(lead, natural)),
+	          serialize(std::make_tuple(lead, Natural<Entry>(entry))));
+
+	Tagged<Paddings> paddings = Paddings{{3, {}, 0x11}, {6, {}, {}}};
+	Preencoded<Tagged<Paddings>> tagged = paddings;
+	EXPECT_EQ(serialize(std::make_tuple(lead, tagged)),
+	          serialize(std::make_tuple(lead, paddings)));
+}
+
+struct World
+{
+	uint32_t tick;
+	std::vector<Trio> entities;
+	std::array<uint16_t, 4> counters;
+	Flags flags;
+	std::string name;
+};
+
+TEST(serialize, delta)
+{
+	World prev{1, {{1, false, 'a'}, {2, true, 'b'}}, {1, 2, 3, 4}, {}, "w"};
+
+	auto bytes = serialize_delta(prev, prev);
+	ASSERT_EQ(bytes.size(), 1);
+	EXPECT_EQ(bytes[0], 0);
+
+	// changed, tick unchanged, entities changed, 64 bit size, first entity
+	// unchanged, second changed with only c changed, then 'c', unchanged
+	// counters, flags and name
+	World curr         = prev;
+	curr.entities[1].c = 'c';
+
+	bytes = serialize_delta(prev, curr);
+	ASSERT_EQ(bytes.size(), 11);
+	EXPECT_EQ(bytes[0], 0b10100000);
+	EXPECT_EQ(bytes[8], 0b01001001);
+	EXPECT_EQ(bytes[9], 'c');
+	EXPECT_EQ(bytes[10], 0b00000000);
+}
+
+TEST(roundtrip, delta)
+{
+	World prev{1, {{1, false, 'a'}, {2, true, 'b'}}, {1, 2, 3, 4}, {}, "w"};
+
+	World grown = prev;
+	grown.tick  = 2;
+	grown.entities.push_back({3, false, 'c'});
+	grown.counters[2] = 7;
+	grown.flags.b     = 3;
+	grown.name        = "world";
+
+	World shrunk = grown;
+	shrunk.entities.resize(1);
+	shrunk.entities[0].a = 9;
+
+	for (const World* next : {&grown, &shrunk})
+	{
+		World t = prev;
+		apply_delta(t, serialize_delta(prev, *next));
+
+		EXPECT_EQ(serialize(t), serialize(*next));
+		prev = *next;
+	}
+}
+
+TEST(serialize, xor_diff)
+{
+	std::vector<uint8_t> prev(40, 0xaa);
+	std::vector<uint8_t> curr = prev;
+	curr[1]                   = 0xab;
+	curr[3]                   = 0xa8;
+	curr[30]                  = 0x55;
+	curr.push_back(0x01);
+
+	// size, a run from 1 to 4 carrying the equal byte at 2, a run at 30 and
+	// the byte past the end of prev
+	auto patch = xor_diff(prev, curr);
+	std::vector<uint8_t> expected{
+	    41, 1, 3, 0x01, 0x00, 0x02, 26, 1, 0xff, 9, 1, 0x01};
+	EXPECT_EQ(patch, expected);
+
+	EXPECT_EQ(xor_diff(prev, prev), std::vector<uint8_t>{40});
+}
+
+TEST(roundtrip, xor_patch)
+{
+	std::vector<uint8_t> prev(1000);
+	for (size_t i = 0; i < prev.size(); ++i)
+	{
+		prev[i] = static_cast<uint8_t>(i * 7);
+	}
+
+	std::vector<uint8_t> grown = prev;
+	grown[17]                  = 0;
+	grown[500]                 = 1;
+	grown[501]                 = 2;
+	grown.insert(grown.end(), {1, 2, 3});
+
+	std::vector<uint8_t> shrunk(grown.begin(), grown.begin() + 600);
+	shrunk[599] = 0;
+
+	for (const auto* next : {&grown, &shrunk, &prev})
+	{
+		auto patch = xor_diff(prev, *next);
+		EXPECT_LT(patch.size(), 32);
+
+		std::vector<uint8_t> frame = prev;
+		xor_patch(frame, patch);
+		EXPECT_EQ(frame, *next);
+
+		prev = *next;
+	}
+
+	// A skip large enough to wrap the position back into the frame.
+	DynamicSerializer ser(ByteOrder::MsbFirst);
+	const uint8_t byte = 0xff;
+	for (size_t v : {size_t{4}, size_t{1}, size_t{1}})
+	{
+		detail::put_varint(v, ser);
+	}
+	ser.write_bytes(&byte, 1);
+	detail::put_varint(std::numeric_limits<size_t>::max(), ser);
+	detail::put_varint(1, ser);
+	ser.write_bytes(&byte, 1);
+	ser.flush();
+
+	std::vector<uint8_t> frame(4);
+	EXPECT_THROW(xor_patch(frame, ser.data()), std::out_of_range);
+}
+
+struct Prebuilt
+{
+	uint16_t id;
+	std::string name;
+	std::vector<uint32_t> values;
+};
+
+PYXI_EXTERN_POLICY(Prebuilt)
+
+TEST(roundtrip, extern_policy)
+{
+	std::vector<Prebuilt> v{{1, "one", {1}}, {2, "two", {2, 2}}};
+
+	auto result = deserialize<std::vector<Prebuilt>>(serialize(v));
+	ASSERT_EQ(result.size(), 2);
+	EXPECT_EQ(result[1].id, 2);
+	EXPECT_EQ(result[1].name, "two");
+	EXPECT_EQ(result[1].values, v[1].values);
+}
+
+PYXI_INSTANTIATE_POLICY(Prebuilt)
+
+#if PYXI_CXX >= 17
+
+TEST(serialize, optional)
+{
+	std::tuple<std::optional<uint8_t>, std::optional<uint8_t>, Bits<uint8_t, 6>>
+	    t{std::nullopt, 0xff, 0b101010};
+
+	auto bytes = serialize(t);
+	ASSERT_EQ(bytes.size(), 2);
+
+	EXPECT_EQ(bytes[0], 0b01111111);
+	EXPECT_EQ(bytes[1], 0b11101010);
+
+	auto result = deserialize<decltype(t)>(bytes);
+	EXPECT_FALSE(std::get<0>(result));
+	EXPECT_EQ(std::get<1>(result), 0xff);
+	EXPECT_EQ(*std::get<2>(result), 0b101010);
+}
+
+TEST(serialize, variant)
+{
+	std::variant<uint8_t, std::string, int16_t> v = int16_t{-2};
+
+	auto bytes = serialize(v);
+	ASSERT_EQ(bytes.size(), 3);
+
+	// 0b10 followed by 0xfffe
+	EXPECT_EQ(bytes[0], 0b10111111);
+	EXPECT_EQ(bytes[1], 0b11111111);
+	EXPECT_EQ(bytes[2], 0b10000000);
+
+	EXPECT_EQ(deserialize<decltype(v)>(bytes), v);
+
+	v = std::string("text");
+	EXPECT_EQ(deserialize<decltype(v)>(serialize(v)), v);
+}
+
+#endif
+
+#if PYXI_CXX >= 17
+
+struct Config
+{
+	std::optional<uint32_t> a;
+	std::optional<std::string> b;
+	uint8_t c;
+	std::optional<uint16_t> d;
+};
+
+TEST(trait, member_tie)
+{
+	size_t count = member_count<Config>::value;
+	EXPECT_EQ(count, 4);
+
+	EXPECT_TRUE_V(is_member_tieable, Config);
+	EXPECT_TRUE_V(is_member_tieable, Flags);
+	EXPECT_FALSE_V(is_member_tieable, Empty);
+
+	Config config{1, "b", 2, 3};
+	std::get<2>(member_tie(config)) = 4;
+	EXPECT_EQ(config.c, 4);
+}
+
+struct Wide
+{
+	int x00, x01, x02, x03, x04, x05, x06, x07, x08, x09;
+	int x10, x11, x12, x13, x14, x15, x16, x17, x18, x19;
+	int x20, x21, x22, x23, x24, x25, x26, x27, x28, x29;
+	int x30, x31, x32, x33, x34, x35, x36, x37, x38, x39;
+	int x40, x41, x42, x43, x44, x45, x46, x47, x48, x49;
+	int x50, x51, x52, x53, x54, x55, x56, x57, x58, x59;
+	int x60, x61, x62, x63, x64, x65, x66, x67, x68, x69;
+	int x70, x71, x72, x73, x74, x75, x76, x77, x78, x79;
+	int x80, x81, x82, x83, x84;
+};
+
+TEST(trait, member_tie_wide)
+{
+	size_t count = member_count<Wide>::value;
+	EXPECT_EQ(count, 85);
+	EXPECT_TRUE_V(is_member_tieable, Wide);
+
+	Wide wide{};
+	std::get<84>(member_tie(wide)) = 7;
+	EXPECT_EQ(wide.x84, 7);
+}
+
+TEST(trait, schema_hash_constexpr)
+{
+	constexpr uint64_t hash = schema_hash<Config>();
+	EXPECT_EQ(hash, schema_hash<Config>());
+	EXPECT_NE(hash, schema_hash<Sparse<Config>>());
+
+	// The compile time hash matches the one computed by binding members.
+	constexpr uint64_t trio = schema_hash<Trio>();
+	EXPECT_EQ(trio,
+	          detail::member_schema_impl<Trio>(
+	              make_sequence<member_count<Trio>::value>{}));
+}
+
+TEST(trait, member_offsets_constexpr)
+{
+	constexpr auto offsets = member_offsets<Config>::value();
+	static_assert(offsets[0] == offsetof(Config, a), "");
+	static_assert(offsets[1] == offsetof(Config, b), "");
+	static_assert(offsets[2] == offsetof(Config, c), "");
+	static_assert(offsets[3] == offsetof(Config, d), "");
+
+	size_t offset = member_offset<Trio, 2>::value;
+	EXPECT_EQ(offset, offsetof(Trio, c));
+}
+
+TEST(roundtrip, optional_members)
+{
+	Config config{std::nullopt, "b", 2, 3};
+
+	auto bytes = serialize(config);
+	ASSERT_EQ(bytes.size(), (1 + 1 + 64 + 8 + 8 + 1 + 16 + 7) / 8);
+
+	Config target = deserialize<Config>(bytes);
+	EXPECT_FALSE(target.a);
+	EXPECT_EQ(target.b, "b");
+	EXPECT_EQ(target.c, 2);
+	EXPECT_EQ(target.d, 3);
+}
+
+TEST(roundtrip, sparse)
+{
+	Sparse<Config> config = Config{std::nullopt, "x", 5, std::nullopt};
+
+	auto bytes = serialize(config);
+
+	// 4 presence bits, b.size(), b, c
+	ASSERT_EQ(bytes.size(), (4 + bitsize<size_t>::value + 8 + 8 + 7) / 8);
+	EXPECT_EQ(bytes[0] >> 4, 0b0110);
+
+	Sparse<Config> target = Config{7, "y", 0, 9};
+	deserialize(target, bytes);
+
+	EXPECT_FALSE(target->a);
+	EXPECT_EQ(target->b, "x");
+	EXPECT_EQ(target->c, 5);
+	EXPECT_FALSE(target->d);
+}
+
+TEST(roundtrip, sparse_wide)
+{
+	Wide wide{};
+	wide.x00 = 1;
+	wide.x63 = 63;
+	wide.x64 = 64;
+	wide.x84 = 84;
+
+	Sparse<Wide> sparse = wide;
+	Sparse<Wide> target;
+	deserialize(target, serialize(sparse));
+
+	EXPECT_EQ(target->x00, 1);
+	EXPECT_EQ(target->x63, 63);
+	EXPECT_EQ(target->x64, 64);
+	EXPECT_EQ(target->x84, 84);
+}
+
+struct Profile
+{
+	uint32_t id;
+	std::string name;
+	Bits<uint8_t, 3> level;
+	std::vector<std::string> tags;
+	std::array<uint16_t, 2> limits;
+	double rating;
+};
+
+TEST(deserialize, view)
+{
+	Profile profile{7, "name", 5, {"a", "bc"}, {{1, 2}}, 4.5};
+
+	auto bytes = serialize(profile);
+
+	View<Profile> view(bytes);
+	EXPECT_EQ(view.get<5>(), 4.5);
+	EXPECT_EQ(view.get<1>(), "name");
+	EXPECT_EQ(*view.get<2>(), 5);
+	EXPECT_EQ(view.get<3>(), profile.tags);
+	EXPECT_EQ(view.get<4>()[1], 2);
+
+	const size_t name = bitsize<size_t>::value + 4 * 8;
+	EXPECT_EQ(view.offset(1), 32);
+	EXPECT_EQ(view.offset(2), 32 + name);
+	EXPECT_EQ(view.offset(3), 32 + name + 3);
+	EXPECT_THROW(view.offset(6), std::out_of_range);
+
+	EXPECT_EQ(view.decode().tags, profile.tags);
+
+	static_assert(detail::fixed_width<Trio>::value == 32 + 8 + 8);
+	static_assert(detail::fixed_width<Profile>::value == 0);
+}
+
+std::string record_path(const char* name)
+{
+	return (std::filesystem::temp_directory_path() /
+	        (std::string("pyxi_") + name + ".pyxr"))
+	    .string();
+}
+
+void write_records(const std::string& path,
+                   size_t count,
+                   RecordWriter::Mode mode)
+{
+	RecordWriter writer(path, schema_hash<Trio>(), mode, 64);
+	for (size_t i = 0; i < count; ++i)
+	{
+		writer.write(Trio{static_cast<uint32_t>(i), i % 2 == 0, 'r'});
+	}
+}
+
+TEST(roundtrip, record_file)
+{
+	const auto path = record_path("roundtrip");
+	write_records(path, 100, RecordWriter::Mode::Truncate);
+
+	RecordReader reader(path);
+	EXPECT_FALSE(reader.recovered());
+	EXPECT_EQ(reader.schema(), schema_hash<Trio>());
+	ASSERT_EQ(reader.size(), 100);
+	EXPECT_EQ(reader.read<Trio>(37).a, 37);
+	EXPECT_EQ(reader.read<Trio>(99).a, 99);
+
+	write_records(path, 10, RecordWriter::Mode::Append);
+
+	RecordReader appended(path);
+	EXPECT_FALSE(appended.recovered());
+	ASSERT_EQ(appended.size(), 110);
+	EXPECT_EQ(appended.read<Trio>(99).a, 99);
+	EXPECT_EQ(appended.read<Trio>(100).a, 0);
+
+	EXPECT_THROW(RecordWriter(path, 0, RecordWriter::Mode::Append),
+	             std::runtime_error);
+
+	std::filesystem::remove(path);
+}
+
+TEST(roundtrip, record_schema)
+{
+	const auto path = record_path("schema");
+
+	{
+		RecordWriter writer(path, schema_hash<Trio>());
+		EXPECT_EQ(writer.schema(), schema_hash<Trio>());
+		EXPECT_THROW(writer.write(uint32_t{7}), std::runtime_error);
+		writer.write(Trio{7, true, 's'});
+	}
+
+	RecordReader reader(path);
+	ASSERT_EQ(reader.size(), 1);
+	EXPECT_THROW(reader.read<uint32_t>(0), std::runtime_error);
+	EXPECT_EQ(reader.read<Trio>(0).c, 's');
+
+	std::filesystem::remove(path);
+}
+
+TEST(roundtrip, record_recovery)
+{
+	const auto path = record_path("recovery");
+	write_records(path, 100, RecordWriter::Mode::Truncate);
+
+	// Lose the footer and half of the last record, as a crash would.
+	const auto offsets = RecordReader(path).offsets();
+	std::filesystem::resize_file(path, offsets[99] + 5);
+
+	RecordReader truncated(path);
+	EXPECT_TRUE(truncated.recovered());
+	ASSERT_EQ(truncated.size(), 99);
+	EXPECT_EQ(truncated.read<Trio>(98).a, 98);
+	EXPECT_EQ(truncated.end(), offsets[99]);
+
+	// Damage a record in the middle; reading resumes at the next sync.
+	{
+		std::fstream f(path, std::ios::binary | std::ios::in | std::ios::out);
+		f.seekp(static_cast<std::streamoff>(offsets[50]));
+		f.put(0x7f);
+	}
+
+	RecordReader damaged(path);
+	EXPECT_TRUE(damaged.recovered());
+	EXPECT_LT(damaged.size(), 99);
+	EXPECT_GT(damaged.size(), 50);
+	EXPECT_EQ(damaged.read<Trio>(damaged.size() - 1).a, 98);
+
+	write_records(path, 1, RecordWriter::Mode::Append);
+
+	RecordReader appended(path);
+	EXPECT_FALSE(appended.recovered());
+	ASSERT_EQ(appended.size(), damaged.size() + 1);
+	EXPECT_EQ(appended.read<Trio>(appended.size() - 2).a, 98);
+
+	std::filesystem::remove(path);
+}
+
+TEST(roundtrip, record_merge)
+{
+	const std::vector<std::string> inputs = {
+	    record_path("merge_a"), record_path("merge_b"), record_path("merge_c")};
+	const auto output = record_path("merge");
+
+	write_records(inputs[0], 40, RecordWriter::Mode::Truncate);
+	write_records(inputs[1], 0, RecordWriter::Mode::Truncate);
+	write_records(inputs[2], 30, RecordWriter::Mode::Truncate);
+
+	// An unclosed input keeps the records written before it stopped.
+	const auto offsets = RecordReader(inputs[2]).offsets();
+	std::filesystem::resize_file(inputs[2], offsets[20] + 3);
+
+	EXPECT_EQ(merge_records(inputs, output, 2, 64), 60);
+
+	RecordReader merged(output);
+	EXPECT_FALSE(merged.recovered());
+	EXPECT_EQ(merged.schema(), schema_hash<Trio>());
+	ASSERT_EQ(merged.size(), 60);
+	EXPECT_EQ(merged.read<Trio>(39).a, 39);
+	EXPECT_EQ(merged.read<Trio>(40).a, 0);
+	EXPECT_EQ(merged.read<Trio>(59).a, 19);
+
+	// Syncs are laid out afresh, so losing the index loses nothing.
+	std::filesystem::resize_file(output, merged.end());
+	RecordReader scanned(output);
+	EXPECT_TRUE(scanned.recovered());
+	EXPECT_EQ(scanned.offsets(), merged.offsets());
+
+	{
+		RecordWriter writer(inputs[1], schema_hash<Tagged<RecordV1>>());
+		writer.write(Tagged<RecordV1>(RecordV1{7, "old"}));
+	}
+
+	EXPECT_THROW(merge_records(inputs, output), std::runtime_error);
+	EXPECT_THROW(merge_records(inputs, inputs[0]), std::invalid_argument);
+
+	{
+		RecordWriter writer(inputs[0], schema_hash<Tagged<RecordV2>>());
+		writer.write(Tagged<RecordV2>(RecordV2{1, "new", 2}));
+	}
+
+	const std::vector<std::string> tagged = {inputs[0], inputs[1]};
+	EXPECT_EQ(merge_records<Tagged<RecordV2>>(tagged, output), 2);
+
+	RecordReader converted(output);
+	EXPECT_EQ(converted.schema(), schema_hash<Tagged<RecordV2>>());
+	EXPECT_EQ(converted.read<Tagged<RecordV2>>(0)->flags, 2);
+	EXPECT_EQ(converted.read<Tagged<RecordV2>>(1)->name, "old");
+
+	for (const auto& path : inputs)
+	{
+		std::filesystem::remove(path);
+	}
+	std::filesystem::remove(output);
+}
+
+struct Station
+{
+	SnapshotString name;
+	uint32_t id;
+	float x;
+	float y;
+	SnapshotArray<uint16_t> lines;
+};
+
+struct Network
+{
+	SnapshotArray<Station> stations;
+	SnapshotString region;
+	uint64_t version;
+};
+
+TEST(roundtrip, snapshot)
+{
+	const auto path = (std::filesystem::temp_directory_path() /
+	                   "pyxi_snapshot.pyxs")
+	                      .string();
+
+	{
+		SnapshotWriter writer(path);
+
+		std::vector<Station> stations;
+		for (uint32_t i = 0; i < 100; ++i)
+		{
+			std::vector<uint16_t> lines(i % 4);
+			for (size_t j = 0; j < lines.size(); ++j)
+			{
+				lines[j] = static_cast<uint16_t>(i + j);
+			}
+
+			stations.push_back(Station{writer.add("station " +
+			                                      std::to_string(i)),
+			                           i,
+			                           i * 0.5f,
+			                           -1.0f,
+			                           writer.add(lines)});
+		}
+
+		writer.finish(Network{writer.add(stations), writer.add("north"), 7});
+	}
+
+	SnapshotReader reader(path);
+	EXPECT_EQ(reader.schema(), schema_hash<Network>());
+	EXPECT_NE(schema_hash<SnapshotArray<uint16_t>>(),
+	          schema_hash<std::vector<uint16_t>>());
+
+	const auto& network = reader.root<Network>();
+	ASSERT_EQ(network.stations.size(), 100);
+	EXPECT_EQ(network.region.view(), "north");
+	EXPECT_EQ(network.version, 7);
+
+	const auto& station = network.stations[42];
+	EXPECT_EQ(station.name.view(), "station 42");
+	EXPECT_STREQ(station.name.c_str(), "station 42");
+	EXPECT_EQ(station.id, 42);
+	EXPECT_EQ(station.x, 21.0f);
+	EXPECT_EQ(std::vector<uint16_t>(station.lines.begin(), station.lines.end()),
+	          (std::vector<uint16_t>{42, 43}));
+
+	EXPECT_TRUE(network.stations[40].lines.empty());
+	EXPECT_EQ(network.stations[40].lines.data(), nullptr);
+
+	uint64_t ids = 0;
+	for (const auto& s : network.stations)
+	{
+		ids += s.id;
+	}
+	EXPECT_EQ(ids, 4950);
+
+	EXPECT_THROW(reader.root<Station>(), std::runtime_error);
+
+	// Without finish the header is never written.
+	{
+		SnapshotWriter writer(path);
+		writer.add("lost");
+	}
+	EXPECT_THROW(SnapshotReader{path}, std::runtime_error);
+
+	std::filesystem::resize_file(path, 8);
+	EXPECT_THROW(SnapshotReader{path}, std::runtime_error);
+
+	std::filesystem::remove(path);
+}
+
+struct alignas(64) Block
+{
+	uint32_t id;
+	SnapshotString name;
+};
+
+TEST(roundtrip, snapshot_overaligned)
+{
+	const auto path = (std::filesystem::temp_directory_path() /
+	                   "pyxi_snapshot_block.pyxs")
+	                      .string();
+
+	{
+		SnapshotWriter writer(path);
+		writer.finish(Block{5, writer.add("b")});
+	}
+
+	SnapshotReader reader(path);
+	const Block& block = reader.root<Block>();
+	EXPECT_EQ(block.id, 5);
+	EXPECT_EQ(block.name.view(), "b");
+
+	// Everything between the string and the root is padding.
+	std::ifstream file(path, std::ios::binary);
+	std::vector<char> bytes((std::istreambuf_iterator<char>(file)),
+	                        std::istreambuf_iterator<char>());
+
+	uint64_t root = 0;
+	std::memcpy(&root, bytes.data() + 16, sizeof(root));
+	ASSERT_EQ(root % 64, 0);
+	ASSERT_LE(root, bytes.size());
+
+	const size_t padding = sizeof(detail::SnapshotHeader) + 2;
+	EXPECT_TRUE(std::all_of(bytes.begin() + padding,
+	                        bytes.begin() + root,
+	                        [](char c) { return c == 0; }));
+
+	std::filesystem::remove(path);
+}
+
+TEST(deserialize, snapshot_cycle)
+{
+	const auto path = (std::filesystem::temp_directory_path() /
+	                   "pyxi_snapshot_cycle.pyxs")
+	                      .string();
+
+	uint64_t stations = 0;
+	{
+		SnapshotWriter writer(path);
+		const std::vector<uint16_t> lines = {4, 5};
+		const auto array = writer.add(std::vector<Station>{
+		    Station{writer.add("hub"), 1, 0.0f, 0.0f, writer.add(lines)}});
+		stations = reinterpret_cast<uintptr_t>(array.data());
+		writer.finish(Network{array, writer.add("north"), 7});
+	}
+
+	{
+		SnapshotReader reader(path);
+		const auto& lines = reader.root<Network>().stations[0].lines;
+		EXPECT_EQ(std::vector<uint16_t>(lines.begin(), lines.end()),
+		          (std::vector<uint16_t>{4, 5}));
+	}
+
+	// Points the lines of the only station back into the array holding it.
+	{
+		std::fstream file(path,
+		                  std::ios::binary | std::ios::in | std::ios::out);
+		file.seekp(
+		    static_cast<std::streamoff>(stations + offsetof(Station, lines)));
+		file.write(reinterpret_cast<const char*>(&stations), sizeof(stations));
+	}
+	EXPECT_THROW(SnapshotReader(path).root<Network>(), std::runtime_error);
+
+	std::filesystem::remove(path);
+}
+
+TEST(deserialize, snapshot_bounds)
+{
+	const auto path = (std::filesystem::temp_directory_path() /
+	                   "pyxi_snapshot_bounds.pyxs")
+	                      .string();
+
+	uint64_t root = 0;
+	{
+		SnapshotWriter writer(path);
+		writer.finish(Network{{}, writer.add("north"), 7});
+	}
+	{
+		std::ifstream file(path, std::ios::binary);
+		file.seekg(16);
+		file.read(reinterpret_cast<char*>(&root), sizeof(root));
+	}
+
+	// Overwrites the size of the region string, which follows the pointer
+	// to its characters.
+	auto resize_region = [&](uint64_t size) {
+		std::fstream file(path,
+		                  std::ios::binary | std::ios::in | std::ios::out);
+		file.seekp(static_cast<std::streamoff>(
+		    root + offsetof(Network, region) + sizeof(void*)));
+		file.write(reinterpret_cast<const char*>(&size), sizeof(size));
+	};
+
+	EXPECT_EQ(SnapshotReader(path).root<Network>().region.view(), "north");
+
+	resize_region(uint64_t{1} << 40);
+	EXPECT_THROW(SnapshotReader(path).root<Network>(), std::runtime_error);
+
+	resize_region(2);
+	EXPECT_THROW(SnapshotReader(path).root<Network>(), std::runtime_error);
+
+	std::filesystem::remove(path);
+}
+
+#endif
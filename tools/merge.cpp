@@ -0,0 +1,115 @@
+// MIT License
+//
+// Copyright (c) 2024 James Geiss
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Merges record files, or compacts a single one, into a new record file.
+
+#include <pyxi_record.hpp>
+
+#include <cerrno>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+
+namespace
+{
+
+int usage()
+{
+	std::cerr << "usage: pyxi_merge [-j threads] [-s sync interval] "
+	             "output input...\n";
+	return 2;
+}
+
+// Reads a decimal count of at least one and at most max, or returns zero.
+unsigned long long parse_count(const char* text, unsigned long long max)
+{
+	if (*text < '0' || *text > '9')
+	{
+		return 0;
+	}
+
+	char* end = nullptr;
+	errno     = 0;
+
+	const unsigned long long count = std::strtoull(text, &end, 10);
+	return *end == '\0' && errno == 0 && count <= max ? count : 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+	unsigned threads    = 0;
+	size_t syncInterval = 1 << 16;
+
+	int i = 1;
+	for (; i + 1 < argc && argv[i][0] == '-'; i += 2)
+	{
+		const std::string option = argv[i];
+		if (option == "-j")
+		{
+			threads = static_cast<unsigned>(parse_count(
+			    argv[i + 1], std::numeric_limits<unsigned>::max()));
+
+			if (threads == 0)
+			{
+				return usage();
+			}
+		}
+		else if (option == "-s")
+		{
+			syncInterval = static_cast<size_t>(parse_count(
+			    argv[i + 1], std::numeric_limits<size_t>::max()));
+
+			if (syncInterval == 0)
+			{
+				return usage();
+			}
+		}
+		else
+		{
+			return usage();
+		}
+	}
+
+	if (argc - i < 2)
+	{
+		return usage();
+	}
+
+	const std::string output = argv[i];
+	const std::vector<std::string> inputs(argv + i + 1, argv + argc);
+
+	try
+	{
+		const size_t count =
+		    pyxi::merge_records(inputs, output, threads, syncInterval);
+		std::cout << count << " records written to " << output << "\n";
+	}
+	catch (const std::exception& e)
+	{
+		std::cerr << "pyxi_merge: " << e.what() << "\n";
+		return 1;
+	}
+
+	return 0;
+}